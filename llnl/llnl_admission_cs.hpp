@@ -0,0 +1,297 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_admission_cs.hpp
+//
+// LRU content store with TinyLFU admission (Einziger, Friedman and Manes, 2017).
+// Every Interest looked up in the store counts one access to its name in a
+// count-min sketch of 4-bit counters; after SampleSize accesses all counters are
+// halved, so old popularity fades. When the store is full, a new Data is only
+// cached if its name has been requested more often than the LRU victim's, which
+// keeps segments requested once from pushing out popular ones.
+//
+// InstallEdgeStores() gives the edge nodes LRU stores, with the filter on all of them
+// or on the ones listed in a file; WriteStats() reports, per node, the lookups, hits
+// and admission decisions.
+
+#ifndef LLNL_ADMISSION_CS_HPP
+#define LLNL_ADMISSION_CS_HPP
+
+#include "ns3/ndnSIM/helper/ndn-stack-helper.hpp"
+#include "ns3/ndnSIM/model/cs/content-store-impl.hpp"
+#include "ns3/ndnSIM/utils/trie/lru-policy.hpp"
+#include "llnl_name_template.hpp"
+
+#include "ns3/names.h"
+#include "ns3/node-container.h"
+#include "ns3/node-list.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+// count-min sketch of 4-bit counters, two per byte, with halving
+class LlnlFrequencySketch
+{
+public:
+  static const int DEPTH = 4;
+
+  void
+  Resize(size_t width, uint64_t sampleSize)
+  {
+    size_t w = 64;
+    while (w < width) {
+      w <<= 1;
+    }
+    m_mask = w - 1;
+    m_table.assign(DEPTH * w / 2, 0);
+    m_sampleSize = sampleSize;
+    m_additions = 0;
+  }
+
+  void
+  Increment(uint64_t hash)
+  {
+    bool added = false;
+    for (int i = 0; i < DEPTH; i++) {
+      size_t slot = Slot(hash, i);
+      uint8_t& cell = m_table[slot / 2];
+      int shift = (slot & 1) * 4;
+      if (((cell >> shift) & 0xF) < 15) {
+        cell += 1 << shift;
+        added = true;
+      }
+    }
+    if (added && ++m_additions >= m_sampleSize) {
+      Age();
+    }
+  }
+
+  uint32_t
+  Estimate(uint64_t hash) const
+  {
+    uint32_t estimate = 15;
+    for (int i = 0; i < DEPTH; i++) {
+      size_t slot = Slot(hash, i);
+      estimate = std::min<uint32_t>(estimate, (m_table[slot / 2] >> ((slot & 1) * 4)) & 0xF);
+    }
+    return estimate;
+  }
+
+  uint64_t
+  GetAgings() const
+  {
+    return m_agings;
+  }
+
+private:
+  // row i of the table, indexed by h1 + i * h2
+  size_t
+  Slot(uint64_t hash, int i) const
+  {
+    uint64_t h1 = hash;
+    uint64_t h2 = (hash >> 32) | 1;
+    return i * (m_mask + 1) + ((h1 + i * h2) & m_mask);
+  }
+
+  void
+  Age()
+  {
+    for (uint8_t& cell : m_table) {
+      cell = (cell >> 1) & 0x77;
+    }
+    m_additions /= 2;
+    m_agings++;
+  }
+
+private:
+  std::vector<uint8_t> m_table;
+  size_t m_mask = 0;
+  uint64_t m_sampleSize = 0;
+  uint64_t m_additions = 0;
+  uint64_t m_agings = 0;
+};
+
+class LlnlTinyLfuContentStore : public ndn::cs::ContentStoreImpl<ndn::ndnSIM::lru_policy_traits>
+{
+public:
+  typedef ndn::cs::ContentStoreImpl<ndn::ndnSIM::lru_policy_traits> Lru;
+
+  struct Stats
+  {
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+    uint64_t offered = 0;  // Data offered for caching
+    uint64_t admitted = 0; // including those cached without a contest while the store had room
+    uint64_t rejected = 0;
+  };
+
+  static TypeId
+  GetTypeId()
+  {
+    static TypeId tid = TypeId("LlnlTinyLfuContentStore")
+      .SetGroupName("Ndn")
+      .SetParent<Lru>()
+      .AddConstructor<LlnlTinyLfuContentStore>()
+      .AddAttribute("SketchWidth", "Counters per sketch row, 0 for 8 per cache slot", UintegerValue(0),
+                    MakeUintegerAccessor(&LlnlTinyLfuContentStore::m_width), MakeUintegerChecker<uint64_t>())
+      .AddAttribute("SampleSize", "Accesses between halvings of the sketch, 0 for 10 per cache slot",
+                    UintegerValue(0), MakeUintegerAccessor(&LlnlTinyLfuContentStore::m_sampleSize),
+                    MakeUintegerChecker<uint64_t>())
+      ;
+    return tid;
+  }
+
+  virtual std::shared_ptr<ndn::Data>
+  Lookup(std::shared_ptr<const ndn::Interest> interest) override
+  {
+    Sketch().Increment(app::nameHash(interest->getName()));
+    m_stats.lookups++;
+    std::shared_ptr<ndn::Data> data = Lru::Lookup(interest);
+    if (data != nullptr) {
+      m_stats.hits++;
+    }
+    return data;
+  }
+
+  virtual bool
+  Add(std::shared_ptr<const ndn::Data> data) override
+  {
+    m_stats.offered++;
+    const auto& policy = getPolicy();
+    if (policy.get_max_size() != 0 && policy.size() >= policy.get_max_size() &&
+        this->find_exact(data->getName()) == this->end()) {
+      const ndn::Name& victim = policy.begin()->payload()->GetName();
+      if (Sketch().Estimate(app::nameHash(data->getName())) <= Sketch().Estimate(app::nameHash(victim))) {
+        m_stats.rejected++;
+        return false;
+      }
+    }
+    bool added = Lru::Add(data);
+    if (added) {
+      m_stats.admitted++;
+    }
+    return added;
+  }
+
+  const Stats&
+  GetStats() const
+  {
+    return m_stats;
+  }
+
+  // node names, one per line, that get the admission filter; '#' starts a comment
+  static std::set<std::string>
+  ReadNodes(const std::string& fileName)
+  {
+    std::set<std::string> nodes;
+    std::ifstream is(fileName);
+    std::string line;
+    while (std::getline(is, line)) {
+      line = line.substr(0, line.find('#'));
+      line.erase(line.find_last_not_of(" \t\r") + 1);
+      line.erase(0, line.find_first_not_of(" \t"));
+      if (!line.empty()) {
+        nodes.insert(line);
+      }
+    }
+    return nodes;
+  }
+
+  // installs the stack on the edge nodes with LRU stores of maxSize: with the admission
+  // filter on the nodes listed in nodesFile, on all of them if it is empty, or on none
+  // unless admission is set
+  static void
+  InstallEdgeStores(ndn::StackHelper& ndnHelper, const NodeContainer& edgeNodes, uint32_t maxSize,
+                    bool admission, const std::string& nodesFile)
+  {
+    if (!admission && nodesFile.empty()) {
+      ndnHelper.SetOldContentStore("ns3::ndn::cs::Lru", "MaxSize", std::to_string(maxSize));
+      ndnHelper.Install(edgeNodes);
+      return;
+    }
+    std::set<std::string> filtered;
+    if (!nodesFile.empty()) {
+      filtered = ReadNodes(nodesFile);
+    }
+    NodeContainer lruNodes;
+    NodeContainer tinyLfuNodes;
+    for (NodeContainer::Iterator i = edgeNodes.Begin(); i != edgeNodes.End(); ++i) {
+      if (filtered.empty() || filtered.count(Names::FindName(*i)) > 0) {
+        tinyLfuNodes.Add(*i);
+      }
+      else {
+        lruNodes.Add(*i);
+      }
+    }
+    std::cout << "Admission filter on " << tinyLfuNodes.GetN() << " of " << edgeNodes.GetN() << " edge nodes"
+              << std::endl;
+    ndnHelper.SetOldContentStore("ns3::ndn::cs::Lru", "MaxSize", std::to_string(maxSize));
+    ndnHelper.Install(lruNodes);
+    ndnHelper.SetOldContentStore("LlnlTinyLfuContentStore", "MaxSize", std::to_string(maxSize));
+    ndnHelper.Install(tinyLfuNodes);
+  }
+
+  static void
+  WriteStats(const std::string& fileName)
+  {
+    std::ofstream os(fileName);
+    os << "node\tlookups\thits\thit_ratio\toffered\tadmitted\trejected\tagings\n";
+    for (NodeList::Iterator node = NodeList::Begin(); node != NodeList::End(); ++node) {
+      Ptr<LlnlTinyLfuContentStore> cs = DynamicCast<LlnlTinyLfuContentStore>((*node)->GetObject<ndn::ContentStore>());
+      if (cs == nullptr) {
+        continue;
+      }
+      const Stats& s = cs->m_stats;
+      os << Names::FindName(*node) << "\t" << s.lookups << "\t" << s.hits << "\t"
+         << (s.lookups > 0 ? static_cast<double>(s.hits) / s.lookups : 0) << "\t" << s.offered << "\t"
+         << s.admitted << "\t" << s.rejected << "\t" << cs->m_sketch.GetAgings() << "\n";
+    }
+  }
+
+private:
+  // sized on first use, when MaxSize is known
+  LlnlFrequencySketch&
+  Sketch()
+  {
+    if (!m_sized) {
+      uint64_t slots = std::max<uint64_t>(getPolicy().get_max_size(), 128);
+      m_sketch.Resize(m_width != 0 ? m_width : 8 * slots, m_sampleSize != 0 ? m_sampleSize : 10 * slots);
+      m_sized = true;
+    }
+    return m_sketch;
+  }
+
+private:
+  uint64_t m_width = 0;
+  uint64_t m_sampleSize = 0;
+  bool m_sized = false;
+  LlnlFrequencySketch m_sketch;
+  Stats m_stats;
+};
+
+} // namespace ns3
+
+#endif // LLNL_ADMISSION_CS_HPP
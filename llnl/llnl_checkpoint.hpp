@@ -0,0 +1,232 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_checkpoint.hpp
+//
+// On-disk format of a simulation checkpoint and the in-memory copy loaded for resume.
+//
+// A checkpoint is a plain text file "checkpoint-<seconds>.txt":
+//
+//   llnl-checkpoint 1
+//   time <ns>
+//   consumer <IP> <start ns> <trace cursor> <#segnum> <#pending>
+//   segnum <nonce> <latest segment>
+//   pending <S|F> <when ns> <lifetime ms> <nonce> <name>
+//   cs <node> <#data>
+//   data <content bytes> <freshness ms> <name>
+//   end
+//
+// "S" pending entries are Interests scheduled but not yet expressed ("when" is the
+// fire time), "F" entries are Interests in flight ("when" is the time they were
+// expressed). PIT entries are rebuilt on resume by re-expressing the in-flight
+// Interests, and strategy measurements are relearned (they only live for 16 s).
+
+#ifndef LLNL_CHECKPOINT_HPP
+#define LLNL_CHECKPOINT_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace app {
+
+struct CheckpointPending
+{
+    bool expressed;
+    int64_t when;       // ns; fire time if scheduled, send time if in flight
+    int64_t lifetime;   // ms
+    uint32_t nonce;
+    std::string name;
+};
+
+struct CheckpointConsumer
+{
+    int64_t start = 0;  // ns, time the consumer read its trace
+    uint64_t cursor = 0; // trace records already issued
+    std::map<uint32_t, uint32_t> segmentNums;
+    std::vector<CheckpointPending> pending;
+};
+
+struct CheckpointData
+{
+    uint64_t contentSize;
+    int64_t freshness;  // ms
+    std::string name;
+};
+
+class LlnlCheckpoint
+{
+public:
+    static LlnlCheckpoint&
+    Get()
+    {
+        static LlnlCheckpoint instance;
+        return instance;
+    }
+
+    bool
+    IsLoaded() const
+    {
+        return m_loaded;
+    }
+
+    // simulated time the checkpoint was taken at, in ns
+    int64_t
+    GetTime() const
+    {
+        return m_time;
+    }
+
+    const CheckpointConsumer*
+    FindConsumer(const std::string& ip) const
+    {
+        auto it = m_consumers.find(ip);
+        return it == m_consumers.end() ? nullptr : &it->second;
+    }
+
+    const std::map<std::string, std::vector<CheckpointData>>&
+    GetContentStores() const
+    {
+        return m_contentStores;
+    }
+
+    static std::string
+    FileName(const std::string& dir, int64_t timeNs)
+    {
+        return dir + "/checkpoint-" + std::to_string(timeNs / 1000000000) + ".txt";
+    }
+
+    // pick the checkpoint with the latest time in dir, empty if there is none
+    static std::string
+    FindLatest(const std::string& dir)
+    {
+        std::string latest;
+        long latestTime = -1;
+        DIR* d = opendir(dir.c_str());
+        if (d == nullptr) {
+            return latest;
+        }
+        while (struct dirent* e = readdir(d)) {
+            long t;
+            char tail[8];
+            if (std::sscanf(e->d_name, "checkpoint-%ld.%7s", &t, tail) == 2 &&
+                std::string(tail) == "txt" && t > latestTime) {
+                latestTime = t;
+                latest = dir + "/" + e->d_name;
+            }
+        }
+        closedir(d);
+        return latest;
+    }
+
+    bool
+    Load(const std::string& fileName)
+    {
+        std::ifstream is(fileName);
+        std::string line;
+        if (!getline(is, line) || line != "llnl-checkpoint 1") {
+            std::cout << "Not a checkpoint file " << fileName << std::endl;
+            return false;
+        }
+
+        CheckpointConsumer* consumer = nullptr;
+        std::vector<CheckpointData>* cs = nullptr;
+        long lineNo = 1;
+        bool complete = false;
+        while (getline(is, line)) {
+            lineNo++;
+            if (line.empty()) {
+                continue;
+            }
+            std::istringstream ss(line);
+            std::string kind;
+            ss >> kind;
+            if (kind == "time") {
+                ss >> m_time;
+            }
+            else if (kind == "consumer") {
+                std::string ip;
+                size_t nSegnum, nPending;
+                ss >> ip;
+                consumer = &m_consumers[ip];
+                ss >> consumer->start >> consumer->cursor >> nSegnum >> nPending;
+                consumer->pending.reserve(nPending);
+            }
+            else if (kind == "segnum" && consumer != nullptr) {
+                uint32_t nonce, seg;
+                ss >> nonce >> seg;
+                consumer->segmentNums[nonce] = seg;
+            }
+            else if (kind == "pending" && consumer != nullptr) {
+                std::string state;
+                CheckpointPending p;
+                ss >> state >> p.when >> p.lifetime >> p.nonce >> p.name;
+                p.expressed = (state == "F");
+                consumer->pending.push_back(p);
+            }
+            else if (kind == "cs") {
+                std::string node;
+                ss >> node;
+                cs = &m_contentStores[node];
+            }
+            else if (kind == "data" && cs != nullptr) {
+                CheckpointData d;
+                ss >> d.contentSize >> d.freshness >> d.name;
+                cs->push_back(d);
+            }
+            else if (kind == "end") {
+                complete = true;
+                break;
+            }
+            if (ss.fail()) {
+                std::cout << "Malformed checkpoint line " << lineNo << " in " << fileName << std::endl;
+                return false;
+            }
+        }
+
+        if (!complete) {
+            std::cout << "Truncated checkpoint " << fileName << std::endl;
+            return false;
+        }
+        m_loaded = true;
+        std::cout << "Loaded checkpoint " << fileName << " at " << m_time / 1000000000 << "s with "
+                  << m_consumers.size() << " consumers and " << m_contentStores.size()
+                  << " content stores" << std::endl;
+        return true;
+    }
+
+private:
+    LlnlCheckpoint() = default;
+
+private:
+    bool m_loaded = false;
+    int64_t m_time = 0;
+    std::map<std::string, CheckpointConsumer> m_consumers;
+    std::map<std::string, std::vector<CheckpointData>> m_contentStores;
+};
+
+} // namespace app
+
+#endif // LLNL_CHECKPOINT_HPP
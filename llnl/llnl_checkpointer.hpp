@@ -0,0 +1,144 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_checkpointer.hpp
+//
+// Periodic checkpoints of consumer state and content stores, and content store
+// restore for resumed runs. See llnl_checkpoint.hpp for the file format.
+
+#ifndef LLNL_CHECKPOINTER_HPP
+#define LLNL_CHECKPOINTER_HPP
+
+#include "llnl_client_starter.hpp"
+#include "llnl_checkpoint.hpp"
+
+#include "ns3/ndnSIM/model/cs/ndn-content-store.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <set>
+
+namespace ns3 {
+
+class LlnlCheckpointer
+{
+public:
+  // Schedule checkpoints every interval seconds (0 disables) plus one at each time
+  // in extra (e.g. the end of warm-up). All checkpoints are scheduled up front so
+  // that they run before any application event sharing their timestamp.
+  static void
+  Schedule(const std::string& dir, double interval, const std::set<double>& extra, double stop)
+  {
+    std::set<double> times = extra;
+    double first = 0;
+    if (LlnlCheckpoint::Get().IsLoaded()) {
+      first = LlnlCheckpoint::Get().GetTime() / 1e9;
+    }
+    if (interval > 0) {
+      for (double t = interval; t < stop; t += interval) {
+        times.insert(t);
+      }
+    }
+    for (double t : times) {
+      if (t > first && t < stop) {
+        Simulator::Schedule(Seconds(t), &LlnlCheckpointer::Write, dir);
+      }
+    }
+    std::cout << "Scheduled " << times.size() << " checkpoints into " << dir << std::endl;
+  }
+
+  static void
+  Write(const std::string& dir)
+  {
+    int64_t now = Simulator::Now().GetNanoSeconds();
+    std::string fileName = app::LlnlCheckpoint::FileName(dir, now);
+    std::string tmpName = fileName + ".tmp";
+    std::ofstream os(tmpName);
+    os << "llnl-checkpoint 1\n";
+    os << "time " << now << "\n";
+
+    size_t nConsumers = 0;
+    size_t nData = 0;
+    for (NodeList::Iterator i = NodeList::Begin(); i != NodeList::End(); ++i) {
+      for (uint32_t a = 0; a < (*i)->GetNApplications(); a++) {
+        Ptr<LlnlClientStarter> starter = DynamicCast<LlnlClientStarter>((*i)->GetApplication(a));
+        if (starter != nullptr && starter->GetConsumer() != nullptr) {
+          starter->GetConsumer()->saveState(os);
+          nConsumers++;
+        }
+      }
+
+      Ptr<ndn::ContentStore> cs = (*i)->GetObject<ndn::ContentStore>();
+      if (cs == nullptr || cs->GetSize() == 0) {
+        continue;
+      }
+      // entries are written in trie order, so LRU recency is not preserved
+      os << "cs " << Names::FindName(*i) << " " << cs->GetSize() << "\n";
+      for (Ptr<ndn::cs::Entry> entry = cs->Begin(); entry != cs->End(); entry = cs->Next(entry)) {
+        auto data = entry->GetData();
+        os << "data " << data->getContent().value_size() << " "
+           << data->getFreshnessPeriod().count() << " " << data->getName().toUri() << "\n";
+        nData++;
+      }
+    }
+    os << "end\n";
+    os.close();
+
+    if (!os || std::rename(tmpName.c_str(), fileName.c_str()) != 0) {
+      std::cout << "Failed to write checkpoint " << fileName << std::endl;
+      return;
+    }
+    std::cout << "Checkpoint " << fileName << " with " << nConsumers << " consumers and "
+              << nData << " cached Data" << std::endl;
+  }
+
+  // Refill the content stores from the loaded checkpoint. Must run after the NDN
+  // stack has been installed.
+  static void
+  RestoreContentStores()
+  {
+    const auto& stores = app::LlnlCheckpoint::Get().GetContentStores();
+    for (const auto& store : stores) {
+      Ptr<Node> node = Names::Find<Node>(store.first);
+      Ptr<ndn::ContentStore> cs = node != nullptr ? node->GetObject<ndn::ContentStore>() : nullptr;
+      if (cs == nullptr) {
+        std::cout << "No content store on " << store.first << " to restore" << std::endl;
+        continue;
+      }
+      for (const auto& d : store.second) {
+        auto data = std::make_shared<::ndn::Data>(::ndn::Name(d.name));
+        data->setFreshnessPeriod(::ndn::time::milliseconds(d.freshness));
+        data->setContent(std::make_shared<::ndn::Buffer>(d.contentSize));
+
+        ::ndn::Signature signature;
+        ::ndn::SignatureInfo signatureInfo(static_cast< ::ndn::tlv::SignatureTypeValue>(255));
+        signature.setInfo(signatureInfo);
+        signature.setValue(::ndn::makeNonNegativeIntegerBlock(::ndn::tlv::SignatureValue, 0));
+        data->setSignature(signature);
+        data->wireEncode();
+
+        cs->Add(data);
+      }
+    }
+  }
+};
+
+} // namespace ns3
+
+#endif // LLNL_CHECKPOINTER_HPP
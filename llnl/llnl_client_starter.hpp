@@ -22,6 +22,7 @@
 #include "llnl_clients.hpp"
 #include "ns3/simulator.h"
 #include "ns3/packet.h"
+#include "ns3/node-list.h"
 
 #include "ns3/ndnSIM/helper/ndn-stack-helper.hpp"
 #include "ns3/ndnSIM/helper/ndn-fib-helper.hpp"
@@ -54,6 +55,8 @@ public:
       .AddAttribute("ID", "ID of Client node", StringValue("none"), MakeStringAccessor(&LlnlClientStarter::SetID, &LlnlClientStarter::GetID), MakeStringChecker())
       .AddAttribute("DICT", "Client DICT Client node", StringValue("none"), MakeStringAccessor(&LlnlClientStarter::SetDICT, &LlnlClientStarter::GetDICT), MakeStringChecker())
       .AddAttribute("TIMESTAMP", "Timestamp", StringValue("none"), MakeStringAccessor(&LlnlClientStarter::SetTimestamp, &LlnlClientStarter::GetTimestamp), MakeStringChecker())
+      .AddAttribute("WindowBegin", "Replay trace records firing at or after this time", TimeValue(Seconds(0)), MakeTimeAccessor(&LlnlClientStarter::m_windowBegin), MakeTimeChecker())
+      .AddAttribute("WindowEnd", "Replay trace records firing before this time", TimeValue(Time::Max()), MakeTimeAccessor(&LlnlClientStarter::m_windowEnd), MakeTimeChecker())
       ;
     return tid;
   }
@@ -107,6 +110,13 @@ public:
 	return ID;
  }
 
+ // running consumer instance, null before start and after stop
+ app::LlnlConsumerWithTimer*
+ GetConsumer() const
+ {
+	return m_instance.get();
+ }
+
 protected:
   // inherited from Application base class.
   virtual void
@@ -115,6 +125,7 @@ protected:
 
     // Create an instance of the app, and passing the dummy version of KeyChain (no real signing)
     m_instance.reset(new app::LlnlConsumerWithTimer(IP, ID, DICT, Timestamp));
+    m_instance->setWindow(m_windowBegin, m_windowEnd);
     m_instance->run(); // can be omitted
   }
 
@@ -131,7 +142,23 @@ private:
   std::string ID;
   std::string DICT;
   std::string Timestamp;
+  Time m_windowBegin;
+  Time m_windowEnd;
 
 };
 
+// count the downloads still running on every client into the completion report
+inline void
+FinishDownloads()
+{
+  for (NodeList::Iterator node = NodeList::Begin(); node != NodeList::End(); ++node) {
+    for (uint32_t a = 0; a < (*node)->GetNApplications(); a++) {
+      Ptr<LlnlClientStarter> starter = DynamicCast<LlnlClientStarter>((*node)->GetApplication(a));
+      if (starter != nullptr && starter->GetConsumer() != nullptr) {
+        starter->GetConsumer()->finishDownloads();
+      }
+    }
+  }
+}
+
 } // namespace ns3
@@ -51,6 +51,16 @@
 
 #include <ns3/node.h>
 
+#include "llnl_checkpoint.hpp"
+#include "llnl_completion.hpp"
+#include "llnl_heavy_hitters.hpp"
+#include "llnl_instrumentation.hpp"
+#include "llnl_name_template.hpp"
+#include "llnl_run_metrics.hpp"
+#include "llnl_trace_parser.hpp"
+#include "llnl_virtual_payload.hpp"
+#include "llnl_workload_scaling.hpp"
+
 namespace app {
 //namespace ndn {
 NS_LOG_COMPONENT_DEFINE("ndn.LlnlConsumer");
@@ -73,6 +83,14 @@ public:
 
     }
 
+    // only replay trace records whose first Interest falls into [begin, end)
+    void
+    setWindow(ns3::Time begin, ns3::Time end)
+    {
+        m_windowBegin = begin;
+        m_windowEnd = end;
+    }
+
     void
     run()
     {
@@ -80,27 +98,45 @@ public:
         std::cout << "IP = " << IP << " ID = " << ID << "Dict Name =" << dict_name << std::endl;
 
         long now = ns3::Simulator::Now().GetSeconds();
+        m_startTime = ns3::Simulator::Now();
+
+        // when resuming, trace records issued before the checkpoint are already
+        // accounted for by the restored request table and pending Interests
+        const CheckpointConsumer* restored = nullptr;
+        if (LlnlCheckpoint::Get().IsLoaded()) {
+            restored = LlnlCheckpoint::Get().FindConsumer(IP);
+        }
+        int64_t resumeAt = LlnlCheckpoint::Get().GetTime();
+        uint64_t skipped = 0;
+
         // Schedule send of first interest
         auto fileName = dict_name + IP + ".client.txt";
         //auto fileName = "src/ndnSIM/examples/llnl/data/" + IP + ".small.txt";
        // auto fileName = "/raid/LLNL_ACCESS_LOG/LLNL_access_logging_extract.csv0.1";
         //auto fileName = "/raid/LLNL_ACCESS_LOG/LLNL_access_log_ASN.csv1.0";
         std::cout << "Starting Simulation at " << now << " filename " << fileName << std::endl;
-        std::ifstream is(fileName);
-        std::string line;
-        std::vector<std::string> parts;
+        // only the dataset (3), request time (9) and size (14) columns are read
+        LlnlTraceParser parser({3, 9, 14});
+        parser.Open(fileName);
+        long base = std::stol(timestamp);
         long count = 0;
-        while(getline(is, line)) {
+        auto thinner = LlnlWorkloadScaling::Get().MakeThinner(IP);
+        while(parser.Next()) {
                 //if ip in line
-                if (line.find(IP) != std::string::npos) {
+                if (parser.Line().contains(IP)) {
                 //        std::cout << "found!" << IP <<  '\n';
-                //        std::cout << "Read line " << line <<  " IP " << IP <<  std::endl;
 
 //            if (count < 20) {
-                boost::split(parts, line, boost::is_any_of("\t"));
+                double size_value;
+                long request_time;
+                if (!LlnlTraceParser::ParseDouble(parser.Get(2), size_value) ||
+                    !LlnlTraceParser::ParseLong(parser.Get(1), request_time)) {
+                    parser.ReportError("bad request time or data size");
+                    continue;
+                }
 
-                auto data_name = parts[3];
-                auto data_size = boost::lexical_cast<float>(parts[14]);
+                auto data_name = parser.Get(0).str();
+                auto data_size = static_cast<float>(size_value);
 
                 auto IntName = "/cmip5/app/" + data_name;
 
@@ -109,7 +145,9 @@ public:
                     maxSegment = 1;
                 }
 
-                auto ndnName = ndn::Name(IntName).appendSegment(maxSegment).appendSegment(0);
+                // encode the dataset name once, segment names only patch the last component
+                SegmentNameTemplate nameTemplate(ndn::Name(IntName).appendSegment(maxSegment));
+                auto ndnName = nameTemplate.make(0);
                 ndn::Interest interest(ndnName);
                 interest.refreshNonce();
 
@@ -121,9 +159,34 @@ public:
                     //don't do anything
                     continue;
                 }
+
+                // thinned before the window check, so every shard keeps the same records
+                if (!thinner.keep(data_name)) {
+                    continue;
+                }
+
+//                 auto time = boost::lexical_cast<long>(parts[8])/100 + segmentNum ;
+                auto time = LlnlWorkloadScaling::Get().ScaleTime(request_time - base);
+                auto delay = ndn::time::nanoseconds(std::llround(time * 1e9));
+//                  auto time = boost::lexical_cast<long>(parts[8])-1324339471/100000;
+
+                auto fireAt = m_startTime + ns3::Seconds(time);
+                if (fireAt < m_windowBegin || fireAt >= m_windowEnd) {
+                    continue;
+                }
+
+                if (LlnlCheckpoint::Get().IsLoaded() &&
+                    fireAt.GetNanoSeconds() < resumeAt) {
+                    skipped++;
+                    continue;
+                }
                 else {
                     //a new request
                     record_segmentNums[initNonce] = 0;
+                    ns3::LlnlPayloadSizes::Get().Register(ndn::Name(IntName), data_size);
+                    if (LlnlRunMetrics::Get().IsCounting(fireAt.GetNanoSeconds())) {
+                        downloads[initNonce] = Download{fireAt, data_size, DownloadProgress(static_cast<uint64_t>(maxSegment))};
+                    }
                     std::cout << "Data Size " << data_size <<  " Max segments = " << maxSegment << std::endl;
                 }
 
@@ -145,11 +208,8 @@ public:
                     record_segmentNums[initNonce]  = record_segmentNums[initNonce]+1;
 //                    std::cout << "Updating (Name, nonce) pair: " << IntName << " " <<   record_segmentNums[initNonce] << std::endl;
 
-                    ndnName = ndnName.getPrefix(-1).appendSegment(segmentNum);
+                    ndnName = nameTemplate.make(segmentNum);
 
-//                 auto time = boost::lexical_cast<long>(parts[8])/100 + segmentNum ;
-                   auto time = (boost::lexical_cast<long>(parts[9])-std::stoi(timestamp));
-//                  auto time = boost::lexical_cast<long>(parts[8])-1324339471/100000;
                     //set lifetime to seconds*1000/10^9 = seconds/10^6
                     interest.setName(ndnName);
                     //1 sec = 1000 secs
@@ -157,8 +217,11 @@ public:
                     interest.setMustBeFresh(true);
                     interest.setNonce(initNonce);
                     std::cout <<  "Scheduling " <<  interest.getName() << " at node "  << ID << " at time " << time <<  "init nonce " <<  initNonce << std::endl;
-                    m_scheduler.scheduleEvent(ndn::time::seconds(time),
-                                              bind(&LlnlConsumerWithTimer::delayedInterest, this, interest));
+                    scheduleInterest(interest, delay, initNonce, true, segmentNum == 0, data_size);
+                }
+                // the rest are asked for from onData, which only patches the segment
+                if (Pipeline < maxSegment) {
+                    recordNames.emplace(initNonce, RecordName{nameTemplate, static_cast<uint64_t>(maxSegment)});
                 }
                //}
             //    else { break; }
@@ -167,6 +230,11 @@ public:
             count++;
             }
         }
+        parser.PrintErrors(std::cout, fileName);
+        if (restored != nullptr) {
+            restore(*restored, skipped);
+        }
+
         std::cout << "Processing event " << std::endl;
 
         //m_ioService.run();
@@ -174,10 +242,164 @@ public:
         m_face.processEvents();
     }
 
+    // Write the request table and the Interests still pending at this point.
+    // Unexpressed Interests of trace records are left out: on resume they are
+    // rescheduled from the trace itself.
+    void
+    saveState(std::ostream& os) const
+    {
+        size_t nPending = 0;
+        for (const auto& entry : outstanding) {
+            if (entry.second.expressed || !entry.second.fromTrace) {
+                nPending++;
+            }
+        }
+
+        os << "consumer " << IP << " " << m_startTime.GetNanoSeconds() << " " << issuedRecords
+           << " " << record_segmentNums.size() << " " << nPending << "\n";
+        for (const auto& seg : record_segmentNums) {
+            os << "segnum " << seg.first << " " << seg.second << "\n";
+        }
+        for (const auto& entry : outstanding) {
+            const Outstanding& o = entry.second;
+            if (!o.expressed && o.fromTrace) {
+                continue;
+            }
+            os << "pending " << (o.expressed ? "F " : "S ") << o.when.GetNanoSeconds() << " "
+               << o.interest.getInterestLifetime().count() << " " << o.interest.getNonce() << " "
+               << o.interest.getName().toUri() << "\n";
+        }
+    }
+
+    // count the downloads still running into the completion report
+    void
+    finishDownloads()
+    {
+        for (const auto& d : downloads) {
+            LlnlCompletionStats::Get().AddUnfinished(IP, d.second.dataSize);
+        }
+        downloads.clear();
+    }
+
+    size_t
+    getOutstandingCount() const
+    {
+        return outstanding.size();
+    }
+
+    // approximate heap footprint of the request table and pending Interests
+    size_t
+    getStateBytes() const
+    {
+        size_t bytes = record_segmentNums.size() * (sizeof(std::pair<uint32_t, uint32_t>) + 32);
+        for (const auto& d : downloads) {
+            bytes += sizeof(d) + 32 + d.second.progress.Size() / 8;
+        }
+        for (const auto& entry : outstanding) {
+            bytes += sizeof(entry) + 32 + entry.second.interest.getName().wireEncode().size();
+        }
+        for (const auto& names : recordNames) {
+            bytes += sizeof(names) + 32 + names.second.name.bufferSize();
+        }
+        return bytes;
+    }
+
 private:
     void
-    onData(const ndn::Interest& interest, const ndn::Data& data)
+    restore(const CheckpointConsumer& restored, uint64_t skipped)
+    {
+        if (skipped != restored.cursor) {
+            std::cout << "Checkpoint cursor mismatch at " << IP << ": skipped " << skipped
+                      << " trace records, checkpoint issued " << restored.cursor << std::endl;
+        }
+        issuedRecords = skipped;
+        record_segmentNums.insert(restored.segmentNums.begin(), restored.segmentNums.end());
+
+        int64_t resumeAt = LlnlCheckpoint::Get().GetTime();
+        int64_t now = ns3::Simulator::Now().GetNanoSeconds();
+        for (const auto& p : restored.pending) {
+            ndn::Interest interest{ndn::Name(p.name)};
+            restoreRecordName(p.nonce, interest.getName());
+            interest.setMustBeFresh(true);
+            interest.setNonce(p.nonce);
+            if (p.expressed) {
+                // re-express in-flight Interests at the resume point with what was left
+                // of their lifetime, which rebuilds the PIT state along the path
+                int64_t left = p.lifetime - (resumeAt - p.when) / 1000000;
+                interest.setInterestLifetime(ndn::time::milliseconds(std::max<int64_t>(left, 1)));
+                scheduleInterest(interest, ndn::time::nanoseconds(resumeAt - now), p.nonce, false, false);
+            }
+            else {
+                interest.setInterestLifetime(ndn::time::milliseconds(p.lifetime));
+                scheduleInterest(interest, ndn::time::nanoseconds(p.when - now), p.nonce, false, false);
+            }
+        }
+        std::cout << "Restored " << IP << " with " << record_segmentNums.size() << " requests and "
+                  << restored.pending.size() << " pending Interests" << std::endl;
+    }
+
+    // segment names of a restored record, from one of its pending Interests
+    void
+    restoreRecordName(uint32_t record, const ndn::Name& name)
+    {
+        if (name.size() < 2 || recordNames.count(record) > 0) {
+            return;
+        }
+        uint64_t maxSegment = 0;
+        try {
+            maxSegment = name.get(-2).toSegment();
+        } catch (std::exception&) {
+            return;
+        }
+        auto requested = record_segmentNums.find(record);
+        if (requested != record_segmentNums.end() && requested->second < maxSegment) {
+            recordNames.emplace(record, RecordName{SegmentNameTemplate(name, name.size() - 1), maxSegment});
+        }
+    }
+
+    void
+    scheduleInterest(const ndn::Interest& interest, ndn::time::nanoseconds delay, uint32_t record,
+                     bool fromTrace, bool opensRecord, float dataSize = 0)
+    {
+        uint64_t seq = nextSeq++;
+        auto fireAt = ns3::Simulator::Now() + ns3::NanoSeconds(delay.count());
+        outstanding.emplace(seq, Outstanding{interest, fireAt, record, false, fromTrace, opensRecord, dataSize});
+        m_scheduler.scheduleEvent(delay, bind(&LlnlConsumerWithTimer::delayedInterest, this, seq));
+    }
+
+    // remove a finished Interest, returning the trace record it belongs to
+    uint32_t
+    takeOutstanding(uint64_t seq, const ndn::Interest& interest)
+    {
+        auto it = outstanding.find(seq);
+        if (it == outstanding.end()) {
+            return interest.getNonce();
+        }
+        uint32_t record = it->second.record;
+        outstanding.erase(it);
+        return record;
+    }
+
+    void
+    onData(const ndn::Interest& interest, const ndn::Data& data, uint64_t seq)
     {
+            LlnlInstrumentation::ScopedTimer timer(PROBE_CONSUMER_DATA);
+            uint32_t record = takeOutstanding(seq, interest);
+
+            // the Interest name ends with the segment, the Data name may carry a version
+            auto download = downloads.find(record);
+            if (download != downloads.end()) {
+                Download& d = download->second;
+                uint64_t segment = d.progress.Size();
+                try {
+                    segment = interest.getName().get(-1).toSegment();
+                } catch (std::exception&) {}
+                if (d.progress.Receive(segment)) {
+                    LlnlCompletionStats::Get().AddCompleted(IP, d.dataSize, (ns3::Simulator::Now() - d.start).GetSeconds());
+                    downloads.erase(download);
+                }
+            }
+
             long now_in_sec = ns3::Simulator::Now().GetSeconds();
             auto now = ns3::Simulator::Now().To(ns3::Time::S);
             auto interestNonce = interest.getNonce();
@@ -192,33 +414,42 @@ private:
             }*/
 
 
+            auto& metrics = LlnlRunMetrics::Get();
+            if (metrics.IsCounting(ns3::Simulator::Now().GetNanoSeconds())) {
+                metrics.data++;
+                if (hopCountTag != nullptr) {
+                    metrics.AddHopCount(*hopCountTag);
+                }
+            }
+
             //lookup how many segments we need to request
             std::cout << "Time: " << now << ",node:" << ID  <<  ",func:Consumer:onData" << ",IP:" <<  IP << " ,Interest Nonce " << interestNonce
             << " ,Data Name "  << data.getName() << ",Hop Count " << *hopCountTag << std::endl;
 
             //we don't need the current segment number, just the latest segment number
-            ndn::Name newInterestName = data.getName().getPrefix(-3);
-            auto maxSeg = 0;
-            try{
-                maxSeg = data.getName().get(-3).toNumber();
-            } catch(std::exception& e){std::cout<< "Passing bad segment number" << data.getName() << e.what() << std::endl;}
-
-            auto latestSeg = record_segmentNums[interestNonce];
+            auto names = recordNames.find(record);
+            if (names == recordNames.end()) {
+                return;
+            }
+            RecordName& recordName = names->second;
+            auto latestSeg = record_segmentNums[record];
 
 
-            //      std::cout << "Look up(Name, nonce) pair: " << newInterestName.toUri() << " " << nonce << "maxSeg = " << maxSeg << " LatestSeg " << latestSeg << std::endl;
+            //      std::cout << "Look up(Name, nonce) pair: " << newInterestName.toUri() << " " << nonce << "maxSeg = " << recordName.maxSegment << " LatestSeg " << latestSeg << std::endl;
 
-            if (latestSeg < maxSeg) {
-                record_segmentNums[interestNonce]  = record_segmentNums[interestNonce]+1;
-                std::cout << "Latest Segment " << latestSeg << "Max segment " << maxSeg << "New Interest Segment " << record_segmentNums[interestNonce] << std::endl;
+            // the pipeline asked for segments 0..latestSeg-1
+            uint64_t nextSeg;
+            if (DownloadProgress::NextSegment(record_segmentNums[record], recordName.maxSegment, nextSeg)) {
+                std::cout << "Latest Segment " << latestSeg << "Max segment " << recordName.maxSegment << "New Interest Segment " << nextSeg << std::endl;
 
-                newInterestName.appendSegment(maxSeg).appendSegment(latestSeg+1);
-                ndn::Interest newInterest(newInterestName);
-                newInterest.setNonce(interestNonce);
+                ndn::Interest newInterest(recordName.name.make(nextSeg));
+                newInterest.setNonce(record);
 
                 auto newTime = now_in_sec;
-                m_scheduler.scheduleEvent(ndn::time::seconds(newTime),
-                                          bind(&LlnlConsumerWithTimer::delayedInterest, this, newInterest));
+                scheduleInterest(newInterest, ndn::time::seconds(newTime), record, false, false);
+            }
+            if (record_segmentNums[record] >= recordName.maxSegment) {
+                recordNames.erase(names);
             }
 
     }
@@ -226,8 +457,17 @@ private:
 
 
     void
-    onNack(const ndn::Interest& interest, const ndn::lp::Nack& nack)
+    onNack(const ndn::Interest& interest, const ndn::lp::Nack& nack, uint64_t seq)
     {
+        // a Nacked segment is not asked for again, so its download cannot complete
+        auto download = downloads.find(takeOutstanding(seq, interest));
+        if (download != downloads.end()) {
+            LlnlCompletionStats::Get().AddAbandoned(IP, download->second.dataSize);
+            downloads.erase(download);
+        }
+        if (LlnlRunMetrics::Get().IsCounting(ns3::Simulator::Now().GetNanoSeconds())) {
+            LlnlRunMetrics::Get().nacks++;
+        }
         NS_LOG_INFO("Received Nack with reason " << nack.getReason()
                     << " for interest " << interest.getName() << " at " << IP);
         auto now = ns3::Simulator::Now().To(ns3::Time::S);
@@ -238,8 +478,14 @@ private:
 
 
     void
-    onTimeout(const ndn::Interest& interest)
+    onTimeout(const ndn::Interest& interest, uint64_t seq)
     {
+        LlnlInstrumentation::ScopedTimer timer(PROBE_CONSUMER_TIMEOUT);
+        // the retransmission carries a fresh nonce, so keep the record it belongs to
+        uint32_t record = takeOutstanding(seq, interest);
+        if (LlnlRunMetrics::Get().IsCounting(ns3::Simulator::Now().GetNanoSeconds())) {
+            LlnlRunMetrics::Get().timeouts++;
+        }
         NS_LOG_INFO( "Timeout " << interest << " at " << IP );
         auto newInterest = ndn::Interest(interest.getName());
         newInterest.setInterestLifetime(ndn::time::seconds(1));
@@ -249,17 +495,43 @@ private:
         auto now = ns3::Simulator::Now().To(ns3::Time::S);
         std::cout << "Time: " << now << ",node:" << ID  <<  ",func:Consumer:onTimeout" << ",IP:" <<  IP << ",Interest Name "  << interest.getName() << std::endl;
 
-        m_scheduler.scheduleEvent(ndn::time::seconds(1),
-                                  bind(&LlnlConsumerWithTimer::delayedInterest, this, newInterest));
+        scheduleInterest(newInterest, ndn::time::seconds(1), record, false, false);
     }
 
     void
-    delayedInterest(const ndn::Interest& interest)
+    delayedInterest(uint64_t seq)
     {
+        LlnlInstrumentation::ScopedTimer timer(PROBE_CONSUMER_INTEREST);
+        auto it = outstanding.find(seq);
+        if (it == outstanding.end()) {
+            return;
+        }
+        it->second.expressed = true;
+        it->second.when = ns3::Simulator::Now();
+        const ndn::Interest& interest = it->second.interest;
+        if (it->second.opensRecord) {
+            issuedRecords++;
+            // /cmip5/app/<dataset>/<max segment>/<segment>
+            const ndn::Name& name = interest.getName();
+            if (LlnlHeavyHitters::Get().IsEnabled() && name.size() >= 5) {
+                LlnlHeavyHitters::Get().Add(ns3::Simulator::Now().GetNanoSeconds(), ID,
+                                            datasetKey(name.getPrefix(-2)),
+                                            static_cast<uint64_t>(std::max(0.0f, it->second.dataSize)));
+            }
+        }
+
+        auto& metrics = LlnlRunMetrics::Get();
+        if (metrics.IsCounting(ns3::Simulator::Now().GetNanoSeconds())) {
+            metrics.interests++;
+            if (it->second.opensRecord) {
+                metrics.requests++;
+            }
+        }
+
         m_face.expressInterest(interest,
-                               bind(&LlnlConsumerWithTimer::onData, this, _1, _2),
-                               bind(&LlnlConsumerWithTimer::onNack, this, _1, _2),
-                               bind(&LlnlConsumerWithTimer::onTimeout, this, _1));
+                               bind(&LlnlConsumerWithTimer::onData, this, _1, _2, seq),
+                               bind(&LlnlConsumerWithTimer::onNack, this, _1, _2, seq),
+                               bind(&LlnlConsumerWithTimer::onTimeout, this, _1, seq));
 
         NS_LOG_INFO("Sending " << interest << " from " << IP);
         auto now = ns3::Simulator::Now().To(ns3::Time::S);
@@ -267,6 +539,37 @@ private:
          << interest.getNonce() << std::endl ;
     }
 
+private:
+    // an Interest from the time it is scheduled until its Data, Nack or timeout
+    struct Outstanding
+    {
+        ndn::Interest interest;
+        ns3::Time when;   // fire time while scheduled, send time once expressed
+        uint32_t record;  // init nonce of the trace record
+        bool expressed;
+        bool fromTrace;
+        bool opensRecord; // first pipeline Interest of a trace record
+        // of the trace record, on the Interest that opens it; Interests restored from
+        // a checkpoint never open one (those that had were counted before it), so
+        // the checkpoint does not keep it
+        float dataSize;
+    };
+
+    // a timed trace record, from its first Interest to its last segment
+    struct Download
+    {
+        ns3::Time start;
+        float dataSize;
+        DownloadProgress progress;
+    };
+
+    // name of a trace record's segments, kept until all of them have been asked for
+    struct RecordName
+    {
+        SegmentNameTemplate name;
+        uint64_t maxSegment;
+    };
+
 private:
     // Explicitly create io_service object, which can be shared between Face and Scheduler
     boost::asio::io_service m_ioService;
@@ -280,5 +583,16 @@ private:
     //init nonce, latest segment
     std::map<uint32_t, uint32_t> record_segmentNums;
     uint32_t segmentSize = 100000000; //100MB
+    // scheduled and in-flight Interests, kept for checkpointing
+    std::map<uint64_t, Outstanding> outstanding;
+    // downloads started inside the measurement window, by init nonce
+    std::map<uint32_t, Download> downloads;
+    // records with segments left to ask for, by init nonce
+    std::map<uint32_t, RecordName> recordNames;
+    uint64_t nextSeq = 0;
+    uint64_t issuedRecords = 0;
+    ns3::Time m_startTime;
+    ns3::Time m_windowBegin = ns3::Seconds(0);
+    ns3::Time m_windowEnd = ns3::Time::Max();
 };
 }//ndn
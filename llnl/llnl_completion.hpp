@@ -0,0 +1,275 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_completion.hpp
+//
+// Dataset download completion times: the time from the first Interest of a trace
+// record to the arrival of its last segment. Durations go into streaming quantile
+// sketches per client, per dataset size class and globally, so memory depends on
+// the spread of the values and not on the number of downloads. Downloads that got
+// a Nack are counted as abandoned, the ones still running at the end as unfinished.
+//
+// The report is one tab-separated row per sketch:
+//
+//   scope key completed abandoned unfinished mean min p50 p90 p99 max
+//
+// with scope "global", "size" (key "1e<k>": datasets of [10^k, 10^(k+1)) bytes)
+// or "client" (key: client IP), and times in seconds.
+
+#ifndef LLNL_COMPLETION_HPP
+#define LLNL_COMPLETION_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace app {
+
+// The segments of one download. A dataset of maxSegment segments (the max segment
+// name component, ceil(size / segment size)) is fetched as segments
+// 0..maxSegment-1: the pipeline asks for the first ones and every Data for the next
+// one, until all have been asked for. Both consumers and llnl_log_analyzer use this
+// definition, so the download they report as complete is the one that was asked for.
+class DownloadProgress
+{
+public:
+    explicit
+    DownloadProgress(uint64_t maxSegment = 0)
+        : m_received(maxSegment)
+        , m_nReceived(0)
+    {
+    }
+
+    // the segment to ask for next, given how many have been asked for; false once
+    // all maxSegment segments have been
+    static bool
+    NextSegment(uint32_t& requested, uint64_t maxSegment, uint64_t& segment)
+    {
+        if (requested >= maxSegment) {
+            return false;
+        }
+        segment = requested++;
+        return true;
+    }
+
+    // segments can arrive more than once after retransmissions, each one counts once;
+    // true when this was the last one missing
+    bool
+    Receive(uint64_t segment)
+    {
+        if (segment >= m_received.size() || m_received[segment]) {
+            return false;
+        }
+        m_received[segment] = true;
+        return ++m_nReceived == m_received.size();
+    }
+
+    bool
+    IsComplete() const
+    {
+        return !m_received.empty() && m_nReceived == m_received.size();
+    }
+
+    size_t
+    Size() const
+    {
+        return m_received.size();
+    }
+
+private:
+    std::vector<bool> m_received;
+    size_t m_nReceived;
+};
+
+// Log-bucketed quantile sketch: bucket i holds values in (gamma^(i-1), gamma^i],
+// so every quantile is returned within the relative accuracy ALPHA.
+class QuantileSketch
+{
+public:
+    static constexpr double ALPHA = 0.01;
+    // values below this (seconds) share one bucket
+    static constexpr double MIN_VALUE = 1e-6;
+
+    void
+    add(double value)
+    {
+        count++;
+        sum += value;
+        min = std::min(min, value);
+        max = std::max(max, value);
+        if (value < MIN_VALUE) {
+            zeros++;
+        }
+        else {
+            m_buckets[index(value)]++;
+        }
+    }
+
+    double
+    quantile(double q) const
+    {
+        if (count == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(q * (count - 1));
+        if (rank < zeros) {
+            return min;
+        }
+        uint64_t seen = zeros;
+        for (const auto& bucket : m_buckets) {
+            seen += bucket.second;
+            if (seen > rank) {
+                // midpoint of the bucket in the relative sense
+                double value = 2 * std::pow(gamma(), bucket.first) / (gamma() + 1);
+                return std::max(min, std::min(max, value));
+            }
+        }
+        return max;
+    }
+
+    double
+    mean() const
+    {
+        return count != 0 ? sum / count : 0;
+    }
+
+    size_t
+    getBucketCount() const
+    {
+        return m_buckets.size();
+    }
+
+public:
+    uint64_t count = 0;
+    uint64_t zeros = 0;
+    double sum = 0;
+    double min = std::numeric_limits<double>::max();
+    double max = 0;
+
+private:
+    static double
+    gamma()
+    {
+        return (1 + ALPHA) / (1 - ALPHA);
+    }
+
+    static int32_t
+    index(double value)
+    {
+        static const double logGamma = std::log(gamma());
+        return static_cast<int32_t>(std::ceil(std::log(value) / logGamma));
+    }
+
+private:
+    std::map<int32_t, uint64_t> m_buckets;
+};
+
+class LlnlCompletionStats
+{
+public:
+    struct Group
+    {
+        QuantileSketch times;
+        uint64_t abandoned = 0;
+        uint64_t unfinished = 0;
+    };
+
+    static LlnlCompletionStats&
+    Get()
+    {
+        static LlnlCompletionStats instance;
+        return instance;
+    }
+
+    void
+    AddCompleted(const std::string& client, double dataSize, double seconds)
+    {
+        m_global.times.add(seconds);
+        m_sizes[SizeClass(dataSize)].times.add(seconds);
+        m_clients[client].times.add(seconds);
+    }
+
+    void
+    AddAbandoned(const std::string& client, double dataSize)
+    {
+        m_global.abandoned++;
+        m_sizes[SizeClass(dataSize)].abandoned++;
+        m_clients[client].abandoned++;
+    }
+
+    void
+    AddUnfinished(const std::string& client, double dataSize)
+    {
+        m_global.unfinished++;
+        m_sizes[SizeClass(dataSize)].unfinished++;
+        m_clients[client].unfinished++;
+    }
+
+    bool
+    Write(const std::string& fileName) const
+    {
+        std::ofstream os(fileName);
+        os << "scope\tkey\tcompleted\tabandoned\tunfinished\tmean\tmin\tp50\tp90\tp99\tmax\n";
+        WriteRow(os, "global", "all", m_global);
+        for (const auto& size : m_sizes) {
+            WriteRow(os, "size", "1e" + std::to_string(size.first), size.second);
+        }
+        for (const auto& client : m_clients) {
+            WriteRow(os, "client", client.first, client.second);
+        }
+        return static_cast<bool>(os);
+    }
+
+    const Group&
+    GetGlobal() const
+    {
+        return m_global;
+    }
+
+private:
+    static int
+    SizeClass(double dataSize)
+    {
+        return dataSize >= 1 ? static_cast<int>(std::floor(std::log10(dataSize))) : 0;
+    }
+
+    static void
+    WriteRow(std::ostream& os, const std::string& scope, const std::string& key, const Group& group)
+    {
+        const QuantileSketch& t = group.times;
+        os << scope << "\t" << key << "\t" << t.count << "\t" << group.abandoned << "\t"
+           << group.unfinished << "\t" << t.mean() << "\t" << (t.count != 0 ? t.min : 0) << "\t"
+           << t.quantile(0.5) << "\t" << t.quantile(0.9) << "\t" << t.quantile(0.99) << "\t"
+           << t.max << "\n";
+    }
+
+private:
+    Group m_global;
+    std::map<int, Group> m_sizes;
+    std::map<std::string, Group> m_clients;
+};
+
+} // namespace app
+
+#endif // LLNL_COMPLETION_HPP
@@ -0,0 +1,396 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_cooperative_cache.hpp
+//
+// Shared state of cooperative edge caching. Each edge node's neighbours are the
+// other edge nodes within a one-way delay budget, nearest first. Every interval
+// each edge node summarises its content store in a Bloom filter that replaces the
+// copy its neighbours hold; the exchange itself is not simulated as packets, only
+// its size is accounted. CooperativeEdgeStrategy asks FindHolder() on a local miss
+// and sends the Interest hop by hop along the shortest-delay path to the holder.
+//
+// The detour target travels with the Interest in a table keyed by its nonce and
+// name, standing in for a forwarding hint; the next hop toward every edge node is
+// precomputed for the nodes within the budget of it.
+
+#ifndef LLNL_COOPERATIVE_CACHE_HPP
+#define LLNL_COOPERATIVE_CACHE_HPP
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/ndnSIM/model/ndn-l3-protocol.hpp"
+#include "ns3/ndnSIM/model/cs/ndn-content-store.hpp"
+#include "llnl_name_template.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+class LlnlBloomFilter
+{
+public:
+  LlnlBloomFilter(size_t bits = 64, uint32_t hashes = 7)
+    : m_words((bits + 63) / 64)
+    , m_hashes(hashes)
+  {
+  }
+
+  void
+  Insert(uint64_t hash)
+  {
+    for (uint32_t i = 0; i < m_hashes; i++) {
+      size_t bit = Bit(hash, i);
+      m_words[bit / 64] |= 1ULL << (bit % 64);
+    }
+  }
+
+  bool
+  MayContain(uint64_t hash) const
+  {
+    for (uint32_t i = 0; i < m_hashes; i++) {
+      size_t bit = Bit(hash, i);
+      if ((m_words[bit / 64] & (1ULL << (bit % 64))) == 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  size_t
+  GetBytes() const
+  {
+    return m_words.size() * sizeof(uint64_t);
+  }
+
+private:
+  size_t
+  Bit(uint64_t hash, uint32_t i) const
+  {
+    uint64_t h2 = (hash >> 32) | 1;
+    return (hash + i * h2) % (m_words.size() * 64);
+  }
+
+private:
+  std::vector<uint64_t> m_words;
+  uint32_t m_hashes;
+};
+
+class LlnlCooperativeCache
+{
+public:
+  struct Parameters
+  {
+    Time budget = MilliSeconds(20); // one-way delay to a neighbour edge
+    Time interval = Seconds(60);    // between summary exchanges
+    uint32_t maxNeighbours = 8;
+    uint32_t bitsPerEntry = 10;
+    uint32_t hashes = 7;
+  };
+
+  struct Stats
+  {
+    uint64_t detours = 0;  // misses sent to a neighbour
+    uint64_t hits = 0;     // answered by the neighbour
+    uint64_t nacks = 0;    // the neighbour did not have it after all
+    uint64_t timeouts = 0;
+    uint64_t summaryBytes = 0; // summaries sent to neighbours
+  };
+
+  static LlnlCooperativeCache&
+  Get()
+  {
+    static LlnlCooperativeCache instance;
+    return instance;
+  }
+
+  // after the NDN stack is installed on every node
+  void
+  Configure(const NodeContainer& edgeNodes, uint32_t cacheSlots, const Parameters& params)
+  {
+    m_params = params;
+    m_filterBits = std::max<size_t>(64, static_cast<size_t>(cacheSlots) * params.bitsPerEntry);
+    m_edges.clear();
+    for (NodeContainer::Iterator i = edgeNodes.Begin(); i != edgeNodes.End(); ++i) {
+      m_edges[(*i)->GetId()] = Edge();
+    }
+    ReadLinks();
+    for (auto& edge : m_edges) {
+      FindNeighbours(edge.first);
+    }
+    m_enabled = true;
+
+    size_t links = 0;
+    for (const auto& edge : m_edges) {
+      links += edge.second.neighbours.size();
+    }
+    std::cout << "Cooperative caching: " << m_edges.size() << " edge nodes, " << links
+              << " neighbour links within " << params.budget.GetMilliSeconds() << "ms" << std::endl;
+    Simulator::Schedule(params.interval, &LlnlCooperativeCache::Exchange, this);
+  }
+
+  bool
+  IsEnabled() const
+  {
+    return m_enabled;
+  }
+
+  bool
+  IsEdge(uint32_t node) const
+  {
+    return m_edges.count(node) > 0;
+  }
+
+  // nearest neighbour of the edge node whose summary has the name, or -1
+  int64_t
+  FindHolder(uint32_t node, const ndn::Name& name) const
+  {
+    auto edge = m_edges.find(node);
+    if (edge == m_edges.end()) {
+      return -1;
+    }
+    uint64_t hash = app::nameHash(name);
+    for (const auto& neighbour : edge->second.neighbours) {
+      const Edge& other = m_edges.at(neighbour.second);
+      if (other.summary.GetBytes() > 0 && other.summary.MayContain(hash)) {
+        return neighbour.second;
+      }
+    }
+    return -1;
+  }
+
+  // face of the node on the shortest-delay path to the edge node, 0 if out of range
+  nfd::FaceId
+  GetNextHop(uint32_t node, uint32_t target) const
+  {
+    auto it = m_nextHop.find(Key(node, target));
+    return it != m_nextHop.end() ? it->second : 0;
+  }
+
+  // the segments of one download share their nonce, so a detour is one segment's
+  void
+  SetDetour(const ndn::Interest& interest, uint32_t target)
+  {
+    m_detours[DetourKey(interest.getNonce(), interest.getName())] = target;
+  }
+
+  // target of the detour the Interest is on, or -1
+  int64_t
+  GetDetour(const ndn::Interest& interest) const
+  {
+    if (m_detours.empty()) {
+      return -1;
+    }
+    auto it = m_detours.find(DetourKey(interest.getNonce(), interest.getName()));
+    return it != m_detours.end() ? it->second : -1;
+  }
+
+  void
+  ClearDetour(uint32_t nonce, const ndn::Name& name)
+  {
+    m_detours.erase(DetourKey(nonce, name));
+  }
+
+  Stats&
+  GetStats(uint32_t node)
+  {
+    return m_edges[node].stats;
+  }
+
+  void
+  WriteStats(const std::string& fileName) const
+  {
+    std::ofstream os(fileName);
+    os << "node\tneighbours\tdetours\thits\tnacks\ttimeouts\tsummary_bytes\n";
+    for (const auto& edge : m_edges) {
+      const Stats& s = edge.second.stats;
+      os << Names::FindName(NodeList::GetNode(edge.first)) << "\t" << edge.second.neighbours.size() << "\t"
+         << s.detours << "\t" << s.hits << "\t" << s.nacks << "\t" << s.timeouts << "\t" << s.summaryBytes
+         << "\n";
+    }
+  }
+
+  void
+  PrintSummary(std::ostream& os) const
+  {
+    Stats total;
+    for (const auto& edge : m_edges) {
+      const Stats& s = edge.second.stats;
+      total.detours += s.detours;
+      total.hits += s.hits;
+      total.nacks += s.nacks;
+      total.timeouts += s.timeouts;
+      total.summaryBytes += s.summaryBytes;
+    }
+    os << "Cooperative caching: " << total.detours << " detours, " << total.hits << " neighbour hits, "
+       << total.nacks << " false positives, " << total.timeouts << " timeouts, "
+       << total.summaryBytes / 1024 << "KB of summaries" << std::endl;
+  }
+
+private:
+  struct Link
+  {
+    uint32_t neighbour;
+    int64_t delay; // ns
+    nfd::FaceId face;
+  };
+
+  struct Edge
+  {
+    std::vector<std::pair<int64_t, uint32_t>> neighbours; // (delay, node), nearest first
+    LlnlBloomFilter summary{0};
+    Stats stats;
+  };
+
+  typedef std::pair<uint32_t, ndn::Name> DetourKey; // (nonce, name)
+
+  struct DetourKeyHash
+  {
+    size_t
+    operator()(const DetourKey& key) const
+    {
+      return app::nameHash(key.second) ^ (key.first * 0x9E3779B97F4A7C15ULL);
+    }
+  };
+
+  static uint64_t
+  Key(uint32_t node, uint32_t target)
+  {
+    return (static_cast<uint64_t>(node) << 32) | target;
+  }
+
+  void
+  ReadLinks()
+  {
+    m_links.assign(NodeList::GetNNodes(), std::vector<Link>());
+    for (NodeList::Iterator node = NodeList::Begin(); node != NodeList::End(); ++node) {
+      Ptr<ndn::L3Protocol> l3 = (*node)->GetObject<ndn::L3Protocol>();
+      for (uint32_t d = 0; l3 != nullptr && d < (*node)->GetNDevices(); d++) {
+        Ptr<PointToPointNetDevice> device = DynamicCast<PointToPointNetDevice>((*node)->GetDevice(d));
+        if (device == nullptr) {
+          continue;
+        }
+        Ptr<PointToPointChannel> channel = DynamicCast<PointToPointChannel>(device->GetChannel());
+        std::shared_ptr<ndn::Face> face = l3->getFaceByNetDevice(device);
+        if (channel == nullptr || face == nullptr) {
+          continue;
+        }
+        Ptr<NetDevice> remote = channel->GetDevice(0) == device ? channel->GetDevice(1) : channel->GetDevice(0);
+        TimeValue delay;
+        channel->GetAttribute("Delay", delay);
+        m_links[(*node)->GetId()].push_back(
+          Link{remote->GetNode()->GetId(), delay.Get().GetNanoSeconds(), face->getId()});
+      }
+    }
+  }
+
+  // Dijkstra from the edge node up to the budget; links are symmetric, so the tree
+  // toward it gives every reached node its next hop to it
+  void
+  FindNeighbours(uint32_t target)
+  {
+    typedef std::pair<int64_t, uint32_t> QueueEntry;
+    std::unordered_map<uint32_t, int64_t> distance;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+    int64_t budget = m_params.budget.GetNanoSeconds();
+    distance[target] = 0;
+    queue.push(QueueEntry(0, target));
+    std::vector<std::pair<int64_t, uint32_t>> reached;
+    while (!queue.empty()) {
+      QueueEntry top = queue.top();
+      queue.pop();
+      if (top.first > distance[top.second]) {
+        continue;
+      }
+      if (top.second != target && IsEdge(top.second)) {
+        reached.push_back(top);
+      }
+      for (const Link& link : m_links[top.second]) {
+        int64_t d = top.first + link.delay;
+        auto known = distance.find(link.neighbour);
+        if (d <= budget && (known == distance.end() || d < known->second)) {
+          distance[link.neighbour] = d;
+          queue.push(QueueEntry(d, link.neighbour));
+          // the reverse link is the neighbour's next hop toward the target
+          for (const Link& back : m_links[link.neighbour]) {
+            if (back.neighbour == top.second) {
+              m_nextHop[Key(link.neighbour, target)] = back.face;
+              break;
+            }
+          }
+        }
+      }
+    }
+
+    // the target becomes a neighbour of the edge nodes it reaches
+    for (const auto& other : reached) {
+      auto& neighbours = m_edges[other.second].neighbours;
+      neighbours.push_back(std::make_pair(other.first, target));
+    }
+    for (const auto& other : reached) {
+      auto& neighbours = m_edges[other.second].neighbours;
+      std::sort(neighbours.begin(), neighbours.end());
+      if (neighbours.size() > m_params.maxNeighbours) {
+        neighbours.resize(m_params.maxNeighbours);
+      }
+    }
+  }
+
+  void
+  Exchange()
+  {
+    for (auto& edge : m_edges) {
+      LlnlBloomFilter summary(m_filterBits, m_params.hashes);
+      Ptr<ndn::ContentStore> cs = NodeList::GetNode(edge.first)->GetObject<ndn::ContentStore>();
+      if (cs != nullptr) {
+        for (Ptr<ndn::cs::Entry> entry = cs->Begin(); entry != cs->End(); entry = cs->Next(entry)) {
+          summary.Insert(app::nameHash(entry->GetName()));
+        }
+      }
+      edge.second.summary = summary;
+    }
+    // each edge node sends its summary to the edge nodes that have it as a neighbour
+    for (auto& edge : m_edges) {
+      for (const auto& neighbour : edge.second.neighbours) {
+        m_edges[neighbour.second].stats.summaryBytes += m_edges[neighbour.second].summary.GetBytes();
+      }
+    }
+    Simulator::Schedule(m_params.interval, &LlnlCooperativeCache::Exchange, this);
+  }
+
+private:
+  Parameters m_params;
+  bool m_enabled = false;
+  size_t m_filterBits = 64;
+  std::unordered_map<uint32_t, Edge> m_edges;
+  std::vector<std::vector<Link>> m_links;
+  std::unordered_map<uint64_t, nfd::FaceId> m_nextHop;
+  std::unordered_map<DetourKey, uint32_t, DetourKeyHash> m_detours;
+};
+
+} // namespace ns3
+
+#endif // LLNL_COOPERATIVE_CACHE_HPP
@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_event_trace.hpp
+//
+// Recorded scheduler operations, replayed by llnl_scheduler_bench. A trace is the
+// magic "LLNLEVT1" followed by 16-byte records in host byte order: the event
+// timestamp (uint64, ns), its uid (uint32) and the operation (uint32, Op).
+
+#ifndef LLNL_EVENT_TRACE_HPP
+#define LLNL_EVENT_TRACE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace app {
+
+struct LlnlEventRecord
+{
+    enum Op : uint32_t {
+        INSERT = 0,
+        REMOVE_NEXT = 1,
+        REMOVE = 2
+    };
+
+    uint64_t ts;
+    uint32_t uid;
+    uint32_t op;
+};
+
+class LlnlEventTraceWriter
+{
+public:
+    enum : size_t { BUFFER = 65536 };
+
+    // at most limit records are written, 0 for no limit
+    bool
+    Open(const std::string& fileName, uint64_t limit)
+    {
+        m_os.open(fileName, std::ios::binary);
+        m_os.write("LLNLEVT1", 8);
+        m_limit = limit;
+        m_buffer.reserve(BUFFER);
+        return static_cast<bool>(m_os);
+    }
+
+    bool
+    IsOpen() const
+    {
+        return m_os.is_open();
+    }
+
+    void
+    Add(uint64_t ts, uint32_t uid, uint32_t op)
+    {
+        if (m_limit != 0 && m_written + m_buffer.size() >= m_limit) {
+            return;
+        }
+        m_buffer.push_back(LlnlEventRecord{ts, uid, op});
+        if (m_buffer.size() == BUFFER) {
+            Flush();
+        }
+    }
+
+    void
+    Flush()
+    {
+        m_os.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size() * sizeof(LlnlEventRecord));
+        m_os.flush();
+        m_written += m_buffer.size();
+        m_buffer.clear();
+    }
+
+    ~LlnlEventTraceWriter()
+    {
+        if (m_os.is_open()) {
+            Flush();
+        }
+    }
+
+private:
+    std::ofstream m_os;
+    std::vector<LlnlEventRecord> m_buffer;
+    uint64_t m_limit = 0;
+    uint64_t m_written = 0;
+};
+
+inline bool
+ReadEventTrace(const std::string& fileName, std::vector<LlnlEventRecord>& records)
+{
+    std::ifstream is(fileName, std::ios::binary);
+    char magic[8];
+    if (!is.read(magic, 8) || std::memcmp(magic, "LLNLEVT1", 8) != 0) {
+        return false;
+    }
+    LlnlEventRecord record;
+    while (is.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        records.push_back(record);
+    }
+    return true;
+}
+
+} // namespace app
+
+#endif // LLNL_EVENT_TRACE_HPP
@@ -0,0 +1,288 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_heartbeat.hpp
+//
+// Progress heartbeat for long runs. LlnlCountingScheduler wraps the real event
+// scheduler, counts executed and pending events and, every CheckInterval events
+// (4096 by default), checks the wall clock; once the heartbeat interval has
+// passed it prints a log line and rewrites a small JSON file with the simulated
+// time reached, event rate, pending events, peak RSS and an ETA to the stop time.
+// With a Record file it also writes every scheduler operation for
+// llnl_scheduler_bench (llnl_event_trace.hpp).
+
+#ifndef LLNL_HEARTBEAT_HPP
+#define LLNL_HEARTBEAT_HPP
+
+#include "llnl_event_trace.hpp"
+
+#include "ns3/core-module.h"
+#include "ns3/scheduler.h"
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+namespace ns3 {
+
+class LlnlHeartbeat
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  // interval in wall-clock seconds (0 disables), stop time in simulated seconds
+  static void
+  Configure(double interval, double stopTime, const std::string& jsonFile)
+  {
+    State& s = GetState();
+    s.interval = interval;
+    s.stopTime = stopTime;
+    s.jsonFile = jsonFile;
+    s.start = s.last = Clock::now();
+  }
+
+  // called by the scheduler every CheckInterval executed events
+  static void
+  OnEvent(uint64_t ts, uint64_t executed, uint64_t pending)
+  {
+    State& s = GetState();
+    if (s.interval <= 0) {
+      return;
+    }
+    auto now = Clock::now();
+    if (std::chrono::duration<double>(now - s.last).count() < s.interval) {
+      return;
+    }
+    Emit(s, now, TimeStep(ts).GetSeconds(), executed, pending);
+  }
+
+  // peak resident set size in KB
+  static long
+  GetPeakRss()
+  {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+  }
+
+private:
+  struct State
+  {
+    double interval = 0;
+    double stopTime = 0;
+    std::string jsonFile;
+    Clock::time_point start;
+    Clock::time_point last;
+    double lastSimTime = 0;
+    uint64_t lastExecuted = 0;
+  };
+
+  static State&
+  GetState()
+  {
+    static State state;
+    return state;
+  }
+
+  static void
+  Emit(State& s, Clock::time_point now, double simTime, uint64_t executed, uint64_t pending)
+  {
+    double wall = std::chrono::duration<double>(now - s.start).count();
+    double sinceLast = std::chrono::duration<double>(now - s.last).count();
+    double eventRate = (executed - s.lastExecuted) / sinceLast;
+
+    // ETA from the simulated-time rate since the last heartbeat, which reacts to
+    // stalls faster than the average over the whole run
+    double simRate = (simTime - s.lastSimTime) / sinceLast;
+    double eta = simRate > 0 ? (s.stopTime - simTime) / simRate : -1;
+    long rss = GetPeakRss();
+
+    std::cout << "Heartbeat sim=" << simTime << "s wall=" << wall << "s events/s=" << eventRate
+              << " pending=" << pending << " peakRss=" << rss / 1024 << "MB eta="
+              << (eta < 0 ? std::string("unknown") : std::to_string(static_cast<long>(eta)) + "s")
+              << std::endl;
+
+    if (!s.jsonFile.empty()) {
+      std::string tmpName = s.jsonFile + ".tmp";
+      std::ofstream os(tmpName);
+      os << "{\"sim_time\": " << simTime
+         << ", \"stop_time\": " << s.stopTime
+         << ", \"wall_time\": " << wall
+         << ", \"events\": " << executed
+         << ", \"events_per_sec\": " << eventRate
+         << ", \"pending_events\": " << pending
+         << ", \"peak_rss_kb\": " << rss
+         << ", \"eta_sec\": " << eta << "}\n";
+      os.close();
+      std::rename(tmpName.c_str(), s.jsonFile.c_str());
+    }
+
+    s.last = now;
+    s.lastSimTime = simTime;
+    s.lastExecuted = executed;
+  }
+};
+
+// Scheduler decorator counting events for the heartbeat; the actual queue is
+// the scheduler named by the "Inner" attribute.
+class LlnlCountingScheduler : public Scheduler
+{
+public:
+  static TypeId
+  GetTypeId()
+  {
+    static TypeId tid = TypeId("LlnlCountingScheduler")
+      .SetParent<Scheduler>()
+      .AddConstructor<LlnlCountingScheduler>()
+      .AddAttribute("Inner", "TypeId of the scheduler holding the events", StringValue("ns3::MapScheduler"),
+                    MakeStringAccessor(&LlnlCountingScheduler::SetInner, &LlnlCountingScheduler::GetInner),
+                    MakeStringChecker())
+      .AddAttribute("CheckInterval", "Executed events between wall-clock checks for the heartbeat",
+                    UintegerValue(4096), MakeUintegerAccessor(&LlnlCountingScheduler::m_checkInterval),
+                    MakeUintegerChecker<uint64_t>(1))
+      .AddAttribute("RecordLimit", "Maximum number of recorded operations, 0 for no limit",
+                    UintegerValue(50000000), MakeUintegerAccessor(&LlnlCountingScheduler::m_recordLimit),
+                    MakeUintegerChecker<uint64_t>())
+      .AddAttribute("Record", "File every scheduler operation is recorded to, empty disables", StringValue(""),
+                    MakeStringAccessor(&LlnlCountingScheduler::SetRecord, &LlnlCountingScheduler::GetRecord),
+                    MakeStringChecker())
+      ;
+    return tid;
+  }
+
+  LlnlCountingScheduler()
+  {
+    SetInner("ns3::MapScheduler");
+  }
+
+  void
+  SetInner(const std::string& typeId)
+  {
+    NS_ASSERT_MSG(m_inner == nullptr || m_inner->IsEmpty(), "cannot replace a scheduler holding events");
+    ObjectFactory factory;
+    factory.SetTypeId(typeId);
+    m_inner = factory.Create<Scheduler>();
+    m_innerName = typeId;
+  }
+
+  std::string
+  GetInner() const
+  {
+    return m_innerName;
+  }
+
+  void
+  SetRecord(const std::string& fileName)
+  {
+    m_recordName = fileName;
+    m_record.reset();
+    if (!fileName.empty()) {
+      m_record.reset(new app::LlnlEventTraceWriter);
+      if (!m_record->Open(fileName, m_recordLimit)) {
+        std::cout << "Cannot record scheduler operations to " << fileName << std::endl;
+        m_record.reset();
+      }
+    }
+  }
+
+  std::string
+  GetRecord() const
+  {
+    return m_recordName;
+  }
+
+  virtual void
+  Insert(const Event& ev) override
+  {
+    m_inner->Insert(ev);
+    m_pending++;
+    if (m_record != nullptr) {
+      m_record->Add(ev.key.m_ts, ev.key.m_uid, app::LlnlEventRecord::INSERT);
+    }
+  }
+
+  virtual bool
+  IsEmpty() const override
+  {
+    return m_inner->IsEmpty();
+  }
+
+  virtual Event
+  PeekNext() const override
+  {
+    return m_inner->PeekNext();
+  }
+
+  virtual Event
+  RemoveNext() override
+  {
+    Event ev = m_inner->RemoveNext();
+    m_pending--;
+    m_executed++;
+    if (m_record != nullptr) {
+      m_record->Add(ev.key.m_ts, ev.key.m_uid, app::LlnlEventRecord::REMOVE_NEXT);
+    }
+    if (m_executed - m_lastCheck >= m_checkInterval) {
+      m_lastCheck = m_executed;
+      LlnlHeartbeat::OnEvent(ev.key.m_ts, m_executed, m_pending);
+    }
+    return ev;
+  }
+
+  virtual void
+  Remove(const Event& ev) override
+  {
+    m_inner->Remove(ev);
+    m_pending--;
+    if (m_record != nullptr) {
+      m_record->Add(ev.key.m_ts, ev.key.m_uid, app::LlnlEventRecord::REMOVE);
+    }
+  }
+
+private:
+  Ptr<Scheduler> m_inner;
+  std::string m_innerName;
+  uint64_t m_pending = 0;
+  uint64_t m_executed = 0;
+  uint64_t m_checkInterval = 4096;
+  uint64_t m_lastCheck = 0;
+  std::string m_recordName;
+  std::unique_ptr<app::LlnlEventTraceWriter> m_record;
+  uint64_t m_recordLimit = 50000000;
+};
+
+// install the counting scheduler in front of inner, before any event is scheduled
+inline void
+InstallCountingScheduler(const std::string& inner, const std::string& record = "", uint64_t checkInterval = 4096)
+{
+  ObjectFactory factory;
+  factory.SetTypeId(LlnlCountingScheduler::GetTypeId());
+  factory.Set("Inner", StringValue(inner));
+  factory.Set("Record", StringValue(record));
+  factory.Set("CheckInterval", UintegerValue(checkInterval));
+  Simulator::SetScheduler(factory);
+}
+
+} // namespace ns3
+
+#endif // LLNL_HEARTBEAT_HPP
@@ -0,0 +1,300 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_heavy_hitters.hpp
+//
+// The datasets with the most requests and bytes, per edge node and globally, kept
+// in space-saving summaries: each summary has a fixed number of counters, and a
+// dataset that has none takes over the smallest one, inheriting its count as the
+// error bound. Memory depends on the number of counters and edge nodes, not on the
+// number of distinct datasets.
+//
+// The consumers add a request when they send the first Interest of a trace record,
+// with the record's data size, keyed by datasetKey() (llnl_name_template.hpp). The
+// summaries are not checkpointed: a resumed run counts the records sent after it.
+// At the end of every interval of simulated time the top K of the interval are
+// written, and the summaries start over; the run's totals are written at the end.
+// One tab-separated row per entry:
+//
+//   time scope key metric rank dataset count error
+//
+// with scope "global" (key "all"), "edge" (key: node ID) or "total", metric
+// "requests" or "bytes", and time the end of the interval in seconds.
+
+#ifndef LLNL_HEAVY_HITTERS_HPP
+#define LLNL_HEAVY_HITTERS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace app {
+
+class SpaceSaving
+{
+public:
+    struct Counter
+    {
+        std::string key;
+        uint64_t count;
+        uint64_t error; // at most this much of count belongs to earlier keys
+    };
+
+    explicit
+    SpaceSaving(size_t capacity = 64)
+        : m_capacity(capacity)
+    {
+    }
+
+    void
+    Add(const std::string& key, uint64_t weight)
+    {
+        total += weight;
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            m_heap[it->second].count += weight;
+            SiftDown(it->second);
+        }
+        else if (m_heap.size() < m_capacity) {
+            m_heap.push_back(Counter{key, weight, 0});
+            m_index[key] = m_heap.size() - 1;
+            SiftUp(m_heap.size() - 1);
+        }
+        else if (m_capacity > 0) {
+            // the key takes over the smallest counter
+            Counter& min = m_heap[0];
+            m_index.erase(min.key);
+            min.error = min.count;
+            min.count += weight;
+            min.key = key;
+            m_index[key] = 0;
+            SiftDown(0);
+        }
+    }
+
+    // the k largest counters, largest first
+    std::vector<Counter>
+    Top(size_t k) const
+    {
+        std::vector<Counter> top(m_heap);
+        k = std::min(k, top.size());
+        std::partial_sort(top.begin(), top.begin() + k, top.end(),
+                          [] (const Counter& a, const Counter& b) {
+                              return a.count > b.count || (a.count == b.count && a.key < b.key);
+                          });
+        top.resize(k);
+        return top;
+    }
+
+    void
+    Clear()
+    {
+        total = 0;
+        m_heap.clear();
+        m_index.clear();
+    }
+
+public:
+    uint64_t total = 0;
+
+private:
+    void
+    Swap(size_t i, size_t j)
+    {
+        std::swap(m_heap[i], m_heap[j]);
+        m_index[m_heap[i].key] = i;
+        m_index[m_heap[j].key] = j;
+    }
+
+    void
+    SiftUp(size_t i)
+    {
+        while (i > 0 && m_heap[i].count < m_heap[(i - 1) / 2].count) {
+            Swap(i, (i - 1) / 2);
+            i = (i - 1) / 2;
+        }
+    }
+
+    void
+    SiftDown(size_t i)
+    {
+        while (true) {
+            size_t smallest = i;
+            for (size_t child = 2 * i + 1; child <= 2 * i + 2 && child < m_heap.size(); child++) {
+                if (m_heap[child].count < m_heap[smallest].count) {
+                    smallest = child;
+                }
+            }
+            if (smallest == i) {
+                return;
+            }
+            Swap(i, smallest);
+            i = smallest;
+        }
+    }
+
+private:
+    size_t m_capacity;
+    std::vector<Counter> m_heap; // min-heap on count
+    std::unordered_map<std::string, size_t> m_index;
+};
+
+class LlnlHeavyHitters
+{
+public:
+    static LlnlHeavyHitters&
+    Get()
+    {
+        static LlnlHeavyHitters instance;
+        return instance;
+    }
+
+    // interval in simulated ns, 0 for one snapshot at the end
+    bool
+    Configure(const std::string& fileName, size_t k, size_t counters, int64_t interval)
+    {
+        m_os.open(fileName);
+        if (!m_os) {
+            return false;
+        }
+        m_os << "time\tscope\tkey\tmetric\trank\tdataset\tcount\terror\n";
+        m_k = k;
+        m_counters = std::max(counters, k);
+        m_interval = interval;
+        m_next = interval;
+        m_global = Summaries(m_counters);
+        m_total = Summaries(m_counters);
+        return true;
+    }
+
+    bool
+    IsEnabled() const
+    {
+        return m_os.is_open();
+    }
+
+    void
+    Add(int64_t now, const std::string& edge, const std::string& dataset, uint64_t bytes)
+    {
+        if (!IsEnabled()) {
+            return;
+        }
+        if (m_interval > 0 && now >= m_next) {
+            Snapshot(m_next);
+            // intervals without requests are left out
+            m_next = (now / m_interval + 1) * m_interval;
+        }
+        auto it = m_edges.find(edge);
+        if (it == m_edges.end()) {
+            it = m_edges.insert(std::make_pair(edge, Summaries(m_counters))).first;
+        }
+        it->second.Add(dataset, bytes);
+        m_global.Add(dataset, bytes);
+        if (m_interval > 0) {
+            m_total.Add(dataset, bytes);
+        }
+    }
+
+    // the last, partial interval and the totals of the run
+    void
+    Finish(int64_t now)
+    {
+        if (!IsEnabled()) {
+            return;
+        }
+        Snapshot(now);
+        if (m_interval > 0) {
+            WriteTop(now, "total", "all", m_total);
+        }
+        m_os.close();
+    }
+
+private:
+    struct Summaries
+    {
+        explicit
+        Summaries(size_t counters = 0)
+            : requests(counters)
+            , bytes(counters)
+        {
+        }
+
+        void
+        Add(const std::string& dataset, uint64_t size)
+        {
+            requests.Add(dataset, 1);
+            bytes.Add(dataset, size);
+        }
+
+        SpaceSaving requests;
+        SpaceSaving bytes;
+    };
+
+    void
+    Snapshot(int64_t time)
+    {
+        if (m_global.requests.total == 0) {
+            return;
+        }
+        WriteTop(time, "global", "all", m_global);
+        m_global.requests.Clear();
+        m_global.bytes.Clear();
+        for (auto& edge : m_edges) {
+            if (edge.second.requests.total > 0) {
+                WriteTop(time, "edge", edge.first, edge.second);
+                edge.second.requests.Clear();
+                edge.second.bytes.Clear();
+            }
+        }
+    }
+
+    void
+    WriteTop(int64_t time, const char* scope, const std::string& key, const Summaries& summaries)
+    {
+        const std::pair<const char*, const SpaceSaving*> metrics[] = {
+            {"requests", &summaries.requests}, {"bytes", &summaries.bytes}
+        };
+        for (const auto& metric : metrics) {
+            size_t rank = 1;
+            for (const auto& counter : metric.second->Top(m_k)) {
+                m_os << time / 1e9 << "\t" << scope << "\t" << key << "\t" << metric.first << "\t" << rank++
+                     << "\t" << counter.key << "\t" << counter.count << "\t" << counter.error << "\n";
+            }
+        }
+    }
+
+private:
+    std::ofstream m_os;
+    size_t m_k = 10;
+    size_t m_counters = 100;
+    int64_t m_interval = 0;
+    int64_t m_next = 0;
+    std::map<std::string, Summaries> m_edges;
+    Summaries m_global;
+    Summaries m_total;
+};
+
+} // namespace app
+
+#endif // LLNL_HEAVY_HITTERS_HPP
@@ -0,0 +1,281 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_instrumentation.hpp
+//
+// Counters, scoped cycle timers and event hooks for the strategy and consumer hot
+// paths. LlnlInstrumentation is a policy chosen at compile time: without
+// LLNL_INSTRUMENTATION defined every call is an empty inline function and the
+// timers are empty objects, so the probes cost nothing; with it (e.g.
+// CXXFLAGS=-DLLNL_INSTRUMENTATION) each thread counts calls, cycles and event
+// values in its own block, and Dump() adds the blocks up at the end of the run.
+//
+// Cycles come from rdtsc on x86 and from the steady clock in ns elsewhere.
+
+#ifndef LLNL_INSTRUMENTATION_HPP
+#define LLNL_INSTRUMENTATION_HPP
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace app {
+
+enum LlnlProbe {
+    PROBE_STRATEGY_RECEIVE_INTEREST, // CloserSiteStrategy::afterReceiveInterest
+    PROBE_STRATEGY_SATISFY_INTEREST, // CloserSiteStrategy::beforeSatisfyInterest
+    PROBE_STRATEGY_UPDATE_NEXTHOPS,  // MyMeasurementInfo::updateStoredNextHops, value: nexthops
+    PROBE_CONSUMER_DATA,             // LlnlConsumerWithTimer::onData
+    PROBE_CONSUMER_INTEREST,         // LlnlConsumerWithTimer::delayedInterest
+    PROBE_CONSUMER_TIMEOUT,          // LlnlConsumerWithTimer::onTimeout
+    N_PROBES
+};
+
+template<bool Enabled>
+class LlnlInstrumentationPolicy;
+
+template<>
+class LlnlInstrumentationPolicy<false>
+{
+public:
+    class ScopedTimer
+    {
+    public:
+        explicit
+        ScopedTimer(LlnlProbe)
+        {
+        }
+    };
+
+    static void
+    Count(LlnlProbe)
+    {
+    }
+
+    static void
+    Event(LlnlProbe, uint64_t)
+    {
+    }
+
+    static void
+    SetHook(void (*)(LlnlProbe, uint64_t))
+    {
+    }
+
+    static void
+    Dump(std::ostream&)
+    {
+    }
+};
+
+template<>
+class LlnlInstrumentationPolicy<true>
+{
+public:
+    typedef void (*Hook)(LlnlProbe probe, uint64_t value);
+
+    class ScopedTimer
+    {
+    public:
+        explicit
+        ScopedTimer(LlnlProbe probe)
+            : m_probe(probe)
+            , m_start(Cycles())
+        {
+        }
+
+        ~ScopedTimer()
+        {
+            Counters& counters = Local();
+            counters.calls[m_probe]++;
+            counters.cycles[m_probe] += Cycles() - m_start;
+        }
+
+    private:
+        LlnlProbe m_probe;
+        uint64_t m_start;
+    };
+
+    static void
+    Count(LlnlProbe probe)
+    {
+        Local().calls[probe]++;
+    }
+
+    // a value observed at the probe, e.g. a size; passed on to the hook if one is set
+    static void
+    Event(LlnlProbe probe, uint64_t value)
+    {
+        Counters& counters = Local();
+        counters.events[probe]++;
+        counters.values[probe] += value;
+        if (GetHook() != nullptr) {
+            GetHook()(probe, value);
+        }
+    }
+
+    static void
+    SetHook(Hook hook)
+    {
+        GetHook() = hook;
+    }
+
+    static void
+    Dump(std::ostream& os)
+    {
+        Counters total;
+        {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            total.Add(registry.retired);
+            for (const Counters* counters : registry.live) {
+                total.Add(*counters);
+            }
+        }
+
+        static const char* NAMES[N_PROBES] = {
+            "strategy.afterReceiveInterest", "strategy.beforeSatisfyInterest",
+            "strategy.updateStoredNextHops", "consumer.onData", "consumer.delayedInterest",
+            "consumer.onTimeout"
+        };
+        os << "Instrumentation (cycles " << (HAS_TSC ? "from rdtsc" : "in ns") << ")" << std::endl;
+        os << std::left << std::setw(34) << "probe" << std::right << std::setw(14) << "calls"
+           << std::setw(18) << "cycles" << std::setw(12) << "per call" << std::setw(12) << "events"
+           << std::setw(12) << "mean value" << std::endl;
+        for (int p = 0; p < N_PROBES; p++) {
+            if (total.calls[p] == 0 && total.events[p] == 0) {
+                continue;
+            }
+            os << std::left << std::setw(34) << NAMES[p] << std::right << std::setw(14) << total.calls[p]
+               << std::setw(18) << total.cycles[p] << std::setw(12)
+               << (total.calls[p] > 0 ? total.cycles[p] / total.calls[p] : 0) << std::setw(12)
+               << total.events[p] << std::setw(12)
+               << (total.events[p] > 0 ? static_cast<double>(total.values[p]) / total.events[p] : 0)
+               << std::endl;
+        }
+    }
+
+private:
+#if defined(__x86_64__) || defined(__i386__)
+    enum : bool { HAS_TSC = true };
+
+    static uint64_t
+    Cycles()
+    {
+        return __rdtsc();
+    }
+#else
+    enum : bool { HAS_TSC = false };
+
+    static uint64_t
+    Cycles()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+#endif
+
+    struct Counters
+    {
+        uint64_t calls[N_PROBES] = {0};
+        uint64_t cycles[N_PROBES] = {0};
+        uint64_t events[N_PROBES] = {0};
+        uint64_t values[N_PROBES] = {0};
+
+        void
+        Add(const Counters& other)
+        {
+            for (int p = 0; p < N_PROBES; p++) {
+                calls[p] += other.calls[p];
+                cycles[p] += other.cycles[p];
+                events[p] += other.events[p];
+                values[p] += other.values[p];
+            }
+        }
+    };
+
+    // every thread's block, and the sum of the blocks of finished threads
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<const Counters*> live;
+        Counters retired;
+    };
+
+    struct ThreadCounters : Counters
+    {
+        ThreadCounters()
+        {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.live.push_back(this);
+        }
+
+        ~ThreadCounters()
+        {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.retired.Add(*this);
+            for (size_t i = 0; i < registry.live.size(); i++) {
+                if (registry.live[i] == this) {
+                    registry.live.erase(registry.live.begin() + i);
+                    break;
+                }
+            }
+        }
+    };
+
+    static Registry&
+    GetRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    static Counters&
+    Local()
+    {
+        static thread_local ThreadCounters counters;
+        return counters;
+    }
+
+    static Hook&
+    GetHook()
+    {
+        static Hook hook = nullptr;
+        return hook;
+    }
+};
+
+#ifdef LLNL_INSTRUMENTATION
+typedef LlnlInstrumentationPolicy<true> LlnlInstrumentation;
+#else
+typedef LlnlInstrumentationPolicy<false> LlnlInstrumentation;
+#endif
+
+} // namespace app
+
+#endif // LLNL_INSTRUMENTATION_HPP
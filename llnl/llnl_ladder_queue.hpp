@@ -0,0 +1,293 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_ladder_queue.hpp
+//
+// Ladder queue (Tang, Goh and Thng, 2005): a priority queue with O(1) amortised
+// insert and remove-min for event lists. Events far in the future are appended,
+// unsorted, to Top. When everything nearer is used up, Top is spread over a rung of
+// buckets, and the first non-empty bucket of the lowest rung either becomes the
+// sorted Bottom, if it is small, or is spread over a finer rung below. New events go
+// to Top, to the bucket of the first rung whose current bucket they do not precede,
+// or into Bottom.
+//
+// Bottom is kept short: when inserts grow it past the threshold it is spread over a
+// new rung of its own. Buckets of width 1, and buckets on the lowest allowed rung, go
+// to Bottom whatever their size, and the threshold then doubles until Bottom is used
+// up, so runs of events at one timestamp cost a sort of the bucket and then appends
+// at the end of Bottom, as later events at that time sort after it.
+//
+// Traits give the time of an item (uint64_t), the total order (Less) and identity
+// (Same, used by Remove).
+
+#ifndef LLNL_LADDER_QUEUE_HPP
+#define LLNL_LADDER_QUEUE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace app {
+
+template<typename T, typename Traits>
+class LadderQueue
+{
+public:
+    enum : size_t {
+        BUCKET_THRESHOLD = 50, // larger buckets are spread over a new rung
+        MAX_RUNGS = 8
+    };
+
+    void
+    Insert(const T& item)
+    {
+        m_size++;
+        uint64_t t = Traits::Time(item);
+        if (t >= m_topStart) {
+            if (m_top.empty() || t < m_topMin) {
+                m_topMin = t;
+            }
+            if (m_top.empty() || t > m_topMax) {
+                m_topMax = t;
+            }
+            m_top.push_back(item);
+            return;
+        }
+        for (size_t r = 0; r < m_nRungs; r++) {
+            Rung& rung = m_rungs[r];
+            if (t >= rung.CurrentStart()) {
+                rung.buckets[(t - rung.start) / rung.width].push_back(item);
+                return;
+            }
+        }
+        m_bottom.insert(std::upper_bound(m_bottom.begin(), m_bottom.end(), item, Less()), item);
+        if (m_bottom.size() > m_bottomLimit) {
+            SpreadBottom();
+        }
+    }
+
+    bool
+    IsEmpty() const
+    {
+        return m_size == 0;
+    }
+
+    size_t
+    Size() const
+    {
+        return m_size;
+    }
+
+    // the queue must not be empty
+    const T&
+    Peek()
+    {
+        Refill();
+        return m_bottom.front();
+    }
+
+    T
+    RemoveNext()
+    {
+        Refill();
+        T item = m_bottom.front();
+        m_bottom.pop_front();
+        m_size--;
+        return item;
+    }
+
+    // an item is where Insert would put it now, so only that place is searched
+    bool
+    Remove(const T& item)
+    {
+        uint64_t t = Traits::Time(item);
+        if (t >= m_topStart) {
+            return Erase(m_top, item);
+        }
+        for (size_t r = 0; r < m_nRungs; r++) {
+            Rung& rung = m_rungs[r];
+            if (t >= rung.CurrentStart()) {
+                return Erase(rung.buckets[(t - rung.start) / rung.width], item);
+            }
+        }
+        auto range = std::equal_range(m_bottom.begin(), m_bottom.end(), item, Less());
+        for (auto it = range.first; it != range.second; ++it) {
+            if (Traits::Same(*it, item)) {
+                m_bottom.erase(it);
+                m_size--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Less
+    {
+        bool
+        operator()(const T& a, const T& b) const
+        {
+            return Traits::Less(a, b);
+        }
+    };
+
+    struct Rung
+    {
+        uint64_t start;
+        uint64_t width;
+        size_t current; // buckets before it are used up
+        std::vector<std::vector<T>> buckets;
+
+        uint64_t
+        CurrentStart() const
+        {
+            return start + current * width;
+        }
+    };
+
+    bool
+    Erase(std::vector<T>& items, const T& item)
+    {
+        for (size_t i = 0; i < items.size(); i++) {
+            if (Traits::Same(items[i], item)) {
+                items[i] = items.back();
+                items.pop_back();
+                m_size--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // rungs are reused, so their bucket vectors keep their capacity
+    Rung&
+    AddRung(uint64_t start, uint64_t width, size_t nBuckets)
+    {
+        if (m_nRungs == m_rungs.size()) {
+            m_rungs.push_back(Rung());
+        }
+        Rung& rung = m_rungs[m_nRungs++];
+        rung.start = start;
+        rung.width = width;
+        rung.current = 0;
+        for (auto& bucket : rung.buckets) {
+            bucket.clear();
+        }
+        if (rung.buckets.size() < nBuckets) {
+            rung.buckets.resize(nBuckets);
+        }
+        else {
+            rung.buckets.erase(rung.buckets.begin() + nBuckets, rung.buckets.end());
+        }
+        return rung;
+    }
+
+    void
+    Spread(Rung& rung, std::vector<T>& items)
+    {
+        for (const T& item : items) {
+            rung.buckets[(Traits::Time(item) - rung.start) / rung.width].push_back(item);
+        }
+        items.clear();
+    }
+
+    // move Bottom onto a new lowest rung, which ends where the rung above continues
+    void
+    SpreadBottom()
+    {
+        uint64_t first = Traits::Time(m_bottom.front());
+        uint64_t last = Traits::Time(m_bottom.back());
+        if (first == last || m_nRungs == MAX_RUNGS) {
+            m_bottomLimit = 2 * m_bottom.size();
+            return;
+        }
+        uint64_t end = m_nRungs > 0 ? m_rungs[m_nRungs - 1].CurrentStart() : m_topStart;
+        uint64_t width = (end - first) / m_bottom.size() + 1;
+        Rung& rung = AddRung(first, width, (end - first - 1) / width + 1);
+        for (const T& item : m_bottom) {
+            rung.buckets[(Traits::Time(item) - rung.start) / rung.width].push_back(item);
+        }
+        m_bottom.clear();
+    }
+
+    void
+    Refill()
+    {
+        if (m_bottom.empty()) {
+            m_bottomLimit = BUCKET_THRESHOLD;
+        }
+        while (m_bottom.empty()) {
+            if (m_nRungs == 0) {
+                if (m_top.empty()) {
+                    m_topStart = 0; // empty, start over
+                    return;
+                }
+                uint64_t width = (m_topMax - m_topMin) / m_top.size() + 1;
+                size_t nBuckets = (m_topMax - m_topMin) / width + 1;
+                Rung& rung = AddRung(m_topMin, width, nBuckets);
+                m_topStart = m_topMin + nBuckets * width;
+                Spread(rung, m_top);
+                continue;
+            }
+
+            Rung& rung = m_rungs[m_nRungs - 1];
+            while (rung.current < rung.buckets.size() && rung.buckets[rung.current].empty()) {
+                rung.current++;
+            }
+            if (rung.current == rung.buckets.size()) {
+                m_nRungs--;
+                continue;
+            }
+
+            std::vector<T>& bucket = rung.buckets[rung.current];
+            uint64_t bucketStart = rung.CurrentStart();
+            uint64_t bucketWidth = rung.width;
+            rung.current++;
+            if (bucket.size() <= BUCKET_THRESHOLD || bucketWidth == 1 || m_nRungs == MAX_RUNGS) {
+                std::sort(bucket.begin(), bucket.end(), Less());
+                m_bottom.assign(bucket.begin(), bucket.end());
+                m_bottomLimit = std::max<size_t>(BUCKET_THRESHOLD, 2 * m_bottom.size());
+                bucket.clear();
+            }
+            else {
+                m_spill.swap(bucket); // AddRung may move the rungs
+                uint64_t width = (bucketWidth + m_spill.size() - 1) / m_spill.size();
+                Rung& child = AddRung(bucketStart, width, (bucketWidth - 1) / width + 1);
+                Spread(child, m_spill);
+            }
+        }
+    }
+
+private:
+    std::vector<T> m_top;
+    uint64_t m_topMin = 0;
+    uint64_t m_topMax = 0;
+    uint64_t m_topStart = 0; // events from here on go to Top
+    std::vector<Rung> m_rungs;
+    size_t m_nRungs = 0;
+    std::deque<T> m_bottom;
+    size_t m_bottomLimit = BUCKET_THRESHOLD;
+    std::vector<T> m_spill;
+    size_t m_size = 0;
+};
+
+} // namespace app
+
+#endif // LLNL_LADDER_QUEUE_HPP
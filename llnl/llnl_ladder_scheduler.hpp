@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_ladder_scheduler.hpp
+//
+// ns-3 event scheduler on the ladder queue of llnl_ladder_queue.hpp. Select it with
+// --scheduler=LlnlLadderScheduler in either scenario; events are ordered by their
+// (timestamp, uid) key exactly as with the ns-3 schedulers.
+
+#ifndef LLNL_LADDER_SCHEDULER_HPP
+#define LLNL_LADDER_SCHEDULER_HPP
+
+#include "llnl_ladder_queue.hpp"
+
+#include "ns3/core-module.h"
+#include "ns3/scheduler.h"
+
+namespace ns3 {
+
+struct LlnlEventTraits
+{
+  static uint64_t
+  Time(const Scheduler::Event& ev)
+  {
+    return ev.key.m_ts;
+  }
+
+  static bool
+  Less(const Scheduler::Event& a, const Scheduler::Event& b)
+  {
+    return a.key < b.key;
+  }
+
+  static bool
+  Same(const Scheduler::Event& a, const Scheduler::Event& b)
+  {
+    return a.key.m_uid == b.key.m_uid;
+  }
+};
+
+class LlnlLadderScheduler : public Scheduler
+{
+public:
+  static TypeId
+  GetTypeId()
+  {
+    static TypeId tid = TypeId("LlnlLadderScheduler")
+      .SetParent<Scheduler>()
+      .AddConstructor<LlnlLadderScheduler>()
+      ;
+    return tid;
+  }
+
+  virtual void
+  Insert(const Event& ev) override
+  {
+    m_queue.Insert(ev);
+  }
+
+  virtual bool
+  IsEmpty() const override
+  {
+    return m_queue.IsEmpty();
+  }
+
+  virtual Event
+  PeekNext() const override
+  {
+    return m_queue.Peek();
+  }
+
+  virtual Event
+  RemoveNext() override
+  {
+    return m_queue.RemoveNext();
+  }
+
+  virtual void
+  Remove(const Event& ev) override
+  {
+    bool removed = m_queue.Remove(ev);
+    NS_ASSERT_MSG(removed, "event " << ev.key.m_uid << " is not scheduled");
+    (void)removed;
+  }
+
+private:
+  // PeekNext may move the next bucket down the ladder
+  mutable app::LadderQueue<Event, LlnlEventTraits> m_queue;
+};
+
+} // namespace ns3
+
+#endif // LLNL_LADDER_SCHEDULER_HPP
@@ -0,0 +1,254 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_link_stats.hpp
+//
+// Per-link accounting for the point-to-point links of the topology, without packet
+// traces. For each direction of each link the transmitted bytes and packets, the
+// drops at the device queue, and the peak and time-averaged queue depth are kept in
+// fixed-width time buckets, and written to one binary file at the end of the run.
+//
+// File layout (host byte order):
+//
+//   char[8]  "LLNLLINK"
+//   uint32   version (1)
+//   uint64   bucket width in ns
+//   uint32   number of buckets
+//   uint32   number of directions
+//   per direction:
+//     uint16 + bytes   sending node name
+//     uint16 + bytes   receiving node name
+//     per bucket: uint64 bytes, uint64 packets, uint64 drops,
+//                 uint32 peak queue (packets), float mean queue (packets)
+
+#ifndef LLNL_LINK_STATS_HPP
+#define LLNL_LINK_STATS_HPP
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/ndnSIM/utils/topology/annotated-topology-reader.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+namespace ns3 {
+
+class LlnlLinkStats
+{
+public:
+  struct Bucket
+  {
+    uint64_t bytes = 0;
+    uint64_t packets = 0;
+    uint64_t drops = 0;
+    uint32_t peakQueue = 0;
+    double queueIntegral = 0; // packets * ns
+  };
+
+  struct Direction
+  {
+    LlnlLinkStats* stats;
+    std::string from;
+    std::string to;
+    std::vector<Bucket> buckets;
+    uint32_t queue = 0;
+    int64_t lastChange = 0;
+
+    uint64_t
+    totalBytes() const
+    {
+      uint64_t total = 0;
+      for (const auto& b : buckets) {
+        total += b.bytes;
+      }
+      return total;
+    }
+  };
+
+  static LlnlLinkStats&
+  Get()
+  {
+    static LlnlLinkStats instance;
+    return instance;
+  }
+
+  // hook every link the reader created
+  void
+  Install(const AnnotatedTopologyReader& reader, Time bucket)
+  {
+    NS_ASSERT_MSG(bucket.GetNanoSeconds() > 0, "Link buckets must be at least a nanosecond wide");
+    m_bucket = bucket.GetNanoSeconds();
+    for (auto link = reader.LinksBegin(); link != reader.LinksEnd(); ++link) {
+      Connect(link->GetFromNetDevice(), link->GetFromNodeName(), link->GetToNodeName());
+      Connect(link->GetToNetDevice(), link->GetToNodeName(), link->GetFromNodeName());
+    }
+    std::cout << "Link accounting on " << m_directions.size() << " link directions" << std::endl;
+  }
+
+  void
+  Write(const std::string& fileName)
+  {
+    int64_t end = Simulator::Now().GetNanoSeconds();
+    uint32_t nBuckets = static_cast<uint32_t>(end / m_bucket) + 1;
+    for (auto& dir : m_directions) {
+      Advance(*dir, end);
+      dir->buckets.resize(nBuckets);
+    }
+
+    std::ofstream os(fileName, std::ios::binary);
+    os.write("LLNLLINK", 8);
+    put<uint32_t>(os, 1);
+    put<uint64_t>(os, m_bucket);
+    put<uint32_t>(os, nBuckets);
+    put<uint32_t>(os, m_directions.size());
+    for (const auto& dir : m_directions) {
+      putString(os, dir->from);
+      putString(os, dir->to);
+      for (uint32_t i = 0; i < nBuckets; i++) {
+        const Bucket& b = dir->buckets[i];
+        int64_t width = std::min<int64_t>(m_bucket, end - static_cast<int64_t>(i) * m_bucket);
+        put<uint64_t>(os, b.bytes);
+        put<uint64_t>(os, b.packets);
+        put<uint64_t>(os, b.drops);
+        put<uint32_t>(os, b.peakQueue);
+        put<float>(os, width > 0 ? static_cast<float>(b.queueIntegral / width) : 0.0f);
+      }
+    }
+    if (!os) {
+      std::cout << "Failed to write link stats to " << fileName << std::endl;
+    }
+  }
+
+  void
+  PrintTop(std::ostream& os, size_t n) const
+  {
+    std::vector<const Direction*> sorted;
+    for (const auto& dir : m_directions) {
+      sorted.push_back(dir.get());
+    }
+    std::sort(sorted.begin(), sorted.end(), [] (const Direction* a, const Direction* b) {
+        return a->totalBytes() > b->totalBytes();
+      });
+
+    os << "Busiest link directions" << std::endl;
+    for (size_t i = 0; i < sorted.size() && i < n; i++) {
+      uint64_t drops = 0;
+      uint32_t peak = 0;
+      for (const auto& b : sorted[i]->buckets) {
+        drops += b.drops;
+        peak = std::max(peak, b.peakQueue);
+      }
+      os << sorted[i]->from << " -> " << sorted[i]->to << " bytes " << sorted[i]->totalBytes()
+         << " peak queue " << peak << " drops " << drops << std::endl;
+    }
+  }
+
+private:
+  void
+  Connect(Ptr<NetDevice> device, const std::string& from, const std::string& to)
+  {
+    Ptr<PointToPointNetDevice> p2p = DynamicCast<PointToPointNetDevice>(device);
+    if (p2p == nullptr) {
+      return;
+    }
+    m_directions.emplace_back(new Direction);
+    Direction* dir = m_directions.back().get();
+    dir->stats = this;
+    dir->from = from;
+    dir->to = to;
+
+    p2p->TraceConnectWithoutContext("PhyTxEnd", MakeBoundCallback(&LlnlLinkStats::OnTxEnd, dir));
+    p2p->TraceConnectWithoutContext("MacTxDrop", MakeBoundCallback(&LlnlLinkStats::OnDrop, dir));
+    p2p->GetQueue()->TraceConnectWithoutContext("PacketsInQueue",
+                                                MakeBoundCallback(&LlnlLinkStats::OnQueue, dir));
+  }
+
+  Bucket&
+  CurrentBucket(Direction& dir)
+  {
+    size_t index = Simulator::Now().GetNanoSeconds() / m_bucket;
+    if (dir.buckets.size() <= index) {
+      dir.buckets.resize(index + 1);
+    }
+    return dir.buckets[index];
+  }
+
+  // integrate the queue depth up to now, splitting at bucket boundaries
+  void
+  Advance(Direction& dir, int64_t now)
+  {
+    while (dir.lastChange < now) {
+      size_t index = dir.lastChange / m_bucket;
+      int64_t until = std::min<int64_t>(now, (index + 1) * m_bucket);
+      if (dir.buckets.size() <= index) {
+        dir.buckets.resize(index + 1);
+      }
+      dir.buckets[index].queueIntegral += static_cast<double>(dir.queue) * (until - dir.lastChange);
+      dir.lastChange = until;
+    }
+  }
+
+  static void
+  OnTxEnd(Direction* dir, Ptr<const Packet> packet)
+  {
+    Bucket& b = dir->stats->CurrentBucket(*dir);
+    b.bytes += packet->GetSize();
+    b.packets++;
+  }
+
+  static void
+  OnDrop(Direction* dir, Ptr<const Packet>)
+  {
+    dir->stats->CurrentBucket(*dir).drops++;
+  }
+
+  static void
+  OnQueue(Direction* dir, uint32_t, uint32_t newValue)
+  {
+    dir->stats->Advance(*dir, Simulator::Now().GetNanoSeconds());
+    dir->queue = newValue;
+    Bucket& b = dir->stats->CurrentBucket(*dir);
+    b.peakQueue = std::max(b.peakQueue, newValue);
+  }
+
+  template<typename T>
+  static void
+  put(std::ostream& os, T value)
+  {
+    os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  static void
+  putString(std::ostream& os, const std::string& value)
+  {
+    put<uint16_t>(os, value.size());
+    os.write(value.data(), value.size());
+  }
+
+private:
+  int64_t m_bucket = 1000000000;
+  std::vector<std::unique_ptr<Direction>> m_directions;
+};
+
+} // namespace ns3
+
+#endif // LLNL_LINK_STATS_HPP
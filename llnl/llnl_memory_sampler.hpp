@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_memory_sampler.hpp
+//
+// Periodic per-node sample of the forwarding tables and consumer state, scheduled
+// on the simulator clock. Each sample appends one tab-separated row per node with
+// non-empty tables:
+//
+//   time node pit pit_bytes cs cs_bytes measurements measurements_bytes
+//   nametree nametree_bytes consumer consumer_bytes total_bytes
+//
+// Byte figures are estimates: entry counts times the size of the table entry and
+// its usual attachments, plus the wire size of cached Data and, with virtual
+// payloads, the logical size of their segments. At the end the top-N nodes by
+// peak total are printed.
+
+#ifndef LLNL_MEMORY_SAMPLER_HPP
+#define LLNL_MEMORY_SAMPLER_HPP
+
+#include "llnl_client_starter.hpp"
+#include "llnl_native_consumer.hpp"
+#include "llnl_virtual_payload.hpp"
+
+#include "ns3/ndnSIM/model/ndn-l3-protocol.hpp"
+#include "ns3/ndnSIM/model/cs/ndn-content-store.hpp"
+#include "ns3/ndnSIM/NFD/daemon/fw/forwarder.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+class LlnlMemorySampler
+{
+public:
+  // rough per-entry costs on top of the entry objects: in/out records and strategy
+  // info for a PIT entry, strategy info with a few weighted faces for a
+  // measurements entry, hash bucket and name for a name tree entry
+  static const size_t PIT_EXTRA = 160;
+  static const size_t MEASUREMENTS_EXTRA = 256;
+  static const size_t NAMETREE_EXTRA = 96;
+  static const size_t CS_ENTRY_OVERHEAD = 128;
+
+  struct Sample
+  {
+    size_t pit = 0;
+    size_t pitBytes = 0;
+    size_t cs = 0;
+    size_t csBytes = 0;
+    size_t measurements = 0;
+    size_t measurementsBytes = 0;
+    size_t nameTree = 0;
+    size_t nameTreeBytes = 0;
+    size_t consumer = 0;
+    size_t consumerBytes = 0;
+
+    size_t
+    total() const
+    {
+      return pitBytes + csBytes + measurementsBytes + nameTreeBytes + consumerBytes;
+    }
+  };
+
+  static LlnlMemorySampler&
+  Get()
+  {
+    static LlnlMemorySampler instance;
+    return instance;
+  }
+
+  void
+  Start(Time interval, const std::string& fileName, size_t topN)
+  {
+    m_interval = interval;
+    m_topN = topN;
+    m_os.open(fileName);
+    m_os << "time\tnode\tpit\tpit_bytes\tcs\tcs_bytes\tmeasurements\tmeasurements_bytes"
+         << "\tnametree\tnametree_bytes\tconsumer\tconsumer_bytes\ttotal_bytes\n";
+    Simulator::Schedule(interval, &LlnlMemorySampler::TakeSample, this);
+  }
+
+  static Sample
+  SampleNode(Ptr<Node> node)
+  {
+    Sample s;
+    Ptr<ndn::L3Protocol> l3 = node->GetObject<ndn::L3Protocol>();
+    if (l3 != nullptr) {
+      nfd::Forwarder& fw = *l3->getForwarder();
+      s.pit = fw.getPit().size();
+      s.pitBytes = s.pit * (sizeof(nfd::pit::Entry) + PIT_EXTRA);
+      s.measurements = fw.getMeasurements().size();
+      s.measurementsBytes = s.measurements * (sizeof(nfd::measurements::Entry) + MEASUREMENTS_EXTRA);
+      s.nameTree = fw.getNameTree().size();
+      s.nameTreeBytes = s.nameTree * (sizeof(nfd::name_tree::Entry) + NAMETREE_EXTRA);
+    }
+
+    Ptr<ndn::ContentStore> cs = node->GetObject<ndn::ContentStore>();
+    if (cs != nullptr) {
+      s.cs = cs->GetSize();
+      for (Ptr<ndn::cs::Entry> entry = cs->Begin(); entry != cs->End(); entry = cs->Next(entry)) {
+        s.csBytes += CS_ENTRY_OVERHEAD + entry->GetData()->wireEncode().size() +
+                     LlnlPayloadSizes::Get().GetSize(entry->GetData()->getName());
+      }
+    }
+
+    for (uint32_t a = 0; a < node->GetNApplications(); a++) {
+      Ptr<LlnlClientStarter> starter = DynamicCast<LlnlClientStarter>(node->GetApplication(a));
+      if (starter != nullptr && starter->GetConsumer() != nullptr) {
+        s.consumer += starter->GetConsumer()->getOutstandingCount();
+        s.consumerBytes += starter->GetConsumer()->getStateBytes();
+      }
+      Ptr<LlnlNativeConsumer> native = DynamicCast<LlnlNativeConsumer>(node->GetApplication(a));
+      if (native != nullptr) {
+        s.consumer += native->GetPendingCount();
+        s.consumerBytes += native->GetStateBytes();
+      }
+    }
+    return s;
+  }
+
+  void
+  PrintSummary(std::ostream& os) const
+  {
+    std::vector<std::pair<size_t, uint32_t>> byPeak;
+    for (const auto& peak : m_peaks) {
+      byPeak.push_back(std::make_pair(peak.second.sample.total(), peak.first));
+    }
+    std::sort(byPeak.rbegin(), byPeak.rend());
+
+    os << "Top " << m_topN << " nodes by peak table memory" << std::endl;
+    for (size_t i = 0; i < byPeak.size() && i < m_topN; i++) {
+      const Peak& peak = m_peaks.at(byPeak[i].second);
+      const Sample& s = peak.sample;
+      os << Names::FindName(NodeList::GetNode(byPeak[i].second)) << " at " << peak.time << "s: total "
+         << s.total() / 1024 << "KB pit " << s.pit << " (" << s.pitBytes / 1024 << "KB) cs " << s.cs
+         << " (" << s.csBytes / 1024 << "KB) measurements " << s.measurements << " ("
+         << s.measurementsBytes / 1024 << "KB) nametree " << s.nameTree << " (" << s.nameTreeBytes / 1024
+         << "KB) consumer " << s.consumer << " (" << s.consumerBytes / 1024 << "KB)" << std::endl;
+    }
+  }
+
+  void
+  Stop()
+  {
+    m_os.close();
+  }
+
+private:
+  struct Peak
+  {
+    double time = 0;
+    Sample sample;
+  };
+
+  void
+  TakeSample()
+  {
+    double now = Simulator::Now().GetSeconds();
+    for (NodeList::Iterator i = NodeList::Begin(); i != NodeList::End(); ++i) {
+      Sample s = SampleNode(*i);
+      if (s.total() == 0) {
+        continue;
+      }
+      m_os << now << "\t" << Names::FindName(*i) << "\t" << s.pit << "\t" << s.pitBytes << "\t"
+           << s.cs << "\t" << s.csBytes << "\t" << s.measurements << "\t" << s.measurementsBytes << "\t"
+           << s.nameTree << "\t" << s.nameTreeBytes << "\t" << s.consumer << "\t" << s.consumerBytes
+           << "\t" << s.total() << "\n";
+
+      Peak& peak = m_peaks[(*i)->GetId()];
+      if (s.total() >= peak.sample.total()) {
+        peak.time = now;
+        peak.sample = s;
+      }
+    }
+    m_os.flush();
+    Simulator::Schedule(m_interval, &LlnlMemorySampler::TakeSample, this);
+  }
+
+private:
+  Time m_interval;
+  size_t m_topN = 10;
+  std::ofstream m_os;
+  std::map<uint32_t, Peak> m_peaks;
+};
+
+} // namespace ns3
+
+#endif // LLNL_MEMORY_SAMPLER_HPP
@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_name_template.hpp
+//
+// Wire-format template for the segment names of one download. The prefix
+// components are encoded once; every new name only rewrites the trailing segment
+// component and the outer Name TLV header in place, then wraps the bytes in a Name.
+// Segment components are encoded like Name::appendSegment (marker 0x00 followed by
+// the shortest big-endian nonNegativeInteger). datasetKey() names the dataset of a
+// download the same way for every consumer, and nameHash() is the name hash shared
+// by the content store sketches and summaries.
+
+#ifndef LLNL_NAME_TEMPLATE_HPP
+#define LLNL_NAME_TEMPLATE_HPP
+
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/encoding/block.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace app {
+
+// dataset of a /cmip5/app/<dataset> prefix, as the URI of the components after
+// /cmip5/app without the leading '/'
+inline std::string
+datasetKey(const ndn::Name& dataset)
+{
+    return dataset.getSubName(2).toUri().substr(1);
+}
+
+// FNV-1a over the name's wire encoding
+inline uint64_t
+nameHash(const ndn::Name& name)
+{
+    const ndn::Block& wire = name.wireEncode();
+    uint64_t hash = 14695981039346656037ULL;
+    for (const uint8_t* p = wire.wire(); p != wire.wire() + wire.size(); p++) {
+        hash = (hash ^ *p) * 1099511628211ULL;
+    }
+    return hash ^ (hash >> 29);
+}
+
+class SegmentNameTemplate
+{
+public:
+    // the Name TLV header (type + up to 5 byte length) is written right-aligned here
+    static const size_t HEADROOM = 6;
+    // segment component: type, length, marker and up to 8 number bytes
+    static const size_t MAX_SEGMENT_SIZE = 11;
+
+    SegmentNameTemplate()
+        : m_buffer(HEADROOM + MAX_SEGMENT_SIZE)
+        , m_prefixEnd(HEADROOM)
+    {
+    }
+
+    // template for segments of prefix
+    explicit
+    SegmentNameTemplate(const ndn::Name& prefix)
+        : SegmentNameTemplate(prefix, prefix.size())
+    {
+    }
+
+    // template for segments of the first nComponents components of name; the
+    // component encodings are copied as they are, without copying the Name
+    SegmentNameTemplate(const ndn::Name& name, size_t nComponents)
+        : SegmentNameTemplate()
+    {
+        for (size_t i = 0; i < nComponents && i < name.size(); i++) {
+            const ndn::Block& component = name.get(i);
+            appendBytes(component.wire(), component.size());
+        }
+    }
+
+    // make segment part of the fixed prefix, e.g. the max segment component
+    SegmentNameTemplate&
+    appendSegment(uint64_t segment)
+    {
+        uint8_t component[MAX_SEGMENT_SIZE];
+        size_t length = encodeSegment(segment, component);
+        appendBytes(component, length);
+        return *this;
+    }
+
+    // name of the given segment
+    ndn::Name
+    make(uint64_t segment)
+    {
+        size_t length = (m_prefixEnd - HEADROOM) + encodeSegment(segment, &m_buffer[m_prefixEnd]);
+        size_t start = writeHeader(length);
+        return ndn::Name(ndn::Block(&m_buffer[start], HEADROOM - start + length));
+    }
+
+    // encoded components of the given segment's name, usable as a lookup key
+    std::string
+    key(uint64_t segment)
+    {
+        size_t length = (m_prefixEnd - HEADROOM) + encodeSegment(segment, &m_buffer[m_prefixEnd]);
+        return std::string(reinterpret_cast<const char*>(&m_buffer[HEADROOM]), length);
+    }
+
+    // bytes held, for memory accounting
+    size_t
+    bufferSize() const
+    {
+        return m_buffer.capacity();
+    }
+
+private:
+    void
+    appendBytes(const uint8_t* bytes, size_t length)
+    {
+        m_buffer.insert(m_buffer.begin() + m_prefixEnd, bytes, bytes + length);
+        m_prefixEnd += length;
+    }
+
+    static size_t
+    encodeSegment(uint64_t segment, uint8_t* out)
+    {
+        size_t numberLength = segment <= 0xFF ? 1 :
+                              segment <= 0xFFFF ? 2 :
+                              segment <= 0xFFFFFFFF ? 4 : 8;
+        out[0] = 8;                  // NameComponent
+        out[1] = 1 + numberLength;
+        out[2] = 0x00;               // segment marker
+        for (size_t i = 0; i < numberLength; i++) {
+            out[3 + i] = static_cast<uint8_t>(segment >> (8 * (numberLength - 1 - i)));
+        }
+        return 3 + numberLength;
+    }
+
+    // write type and length of the Name TLV so that it ends at HEADROOM, return its start
+    size_t
+    writeHeader(size_t length)
+    {
+        size_t pos = HEADROOM;
+        if (length < 253) {
+            m_buffer[--pos] = static_cast<uint8_t>(length);
+        }
+        else if (length <= 0xFFFF) {
+            m_buffer[--pos] = static_cast<uint8_t>(length);
+            m_buffer[--pos] = static_cast<uint8_t>(length >> 8);
+            m_buffer[--pos] = 253;
+        }
+        else {
+            for (int i = 0; i < 4; i++) {
+                m_buffer[--pos] = static_cast<uint8_t>(length >> (8 * i));
+            }
+            m_buffer[--pos] = 254;
+        }
+        m_buffer[--pos] = 7;         // Name
+        return pos;
+    }
+
+private:
+    std::vector<uint8_t> m_buffer;
+    size_t m_prefixEnd;
+};
+
+} // namespace app
+
+#endif // LLNL_NAME_TEMPLATE_HPP
@@ -0,0 +1,421 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_native_consumer.hpp
+//
+// Replays the same trace as LlnlConsumerWithTimer, but directly on top of the ndnSIM
+// App interface: no io_service, Face or Scheduler per client, events are scheduled on
+// ns3::Simulator with a small POD record, and Interests are only built when sent.
+
+#ifndef LLNL_NATIVE_CONSUMER_HPP
+#define LLNL_NATIVE_CONSUMER_HPP
+
+#include "llnl_completion.hpp"
+#include "llnl_heavy_hitters.hpp"
+#include "llnl_name_template.hpp"
+#include "llnl_run_metrics.hpp"
+#include "llnl_trace_parser.hpp"
+#include "llnl_virtual_payload.hpp"
+#include "llnl_workload_scaling.hpp"
+
+#include "ns3/ndnSIM/apps/ndn-app.hpp"
+#include "ns3/ndnSIM/helper/ndn-stack-helper.hpp"
+
+#include "ns3/core-module.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simulator.h"
+
+#include <ndn-cxx/lp/tags.hpp>
+
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+class LlnlNativeConsumer : public ndn::App
+{
+public:
+  static TypeId
+  GetTypeId()
+  {
+    static TypeId tid = TypeId("LlnlNativeConsumer")
+      .SetParent<ndn::App>()
+      .AddConstructor<LlnlNativeConsumer>()
+      .AddAttribute("IP", "IP of Client node", StringValue("none"), MakeStringAccessor(&LlnlNativeConsumer::m_ip), MakeStringChecker())
+      .AddAttribute("DICT", "Directory of the client trace files", StringValue("none"), MakeStringAccessor(&LlnlNativeConsumer::m_dict), MakeStringChecker())
+      .AddAttribute("TIMESTAMP", "Timestamp", StringValue("none"), MakeStringAccessor(&LlnlNativeConsumer::m_timestamp), MakeStringChecker())
+      .AddAttribute("WindowBegin", "Replay trace records firing at or after this time", TimeValue(Seconds(0)), MakeTimeAccessor(&LlnlNativeConsumer::m_windowBegin), MakeTimeChecker())
+      .AddAttribute("WindowEnd", "Replay trace records firing before this time", TimeValue(Time::Max()), MakeTimeAccessor(&LlnlNativeConsumer::m_windowEnd), MakeTimeChecker())
+      ;
+    return tid;
+  }
+
+  LlnlNativeConsumer()
+    : m_rand(CreateObject<UniformRandomVariable>())
+  {
+  }
+
+  size_t
+  GetPendingCount() const
+  {
+    return m_pending.size();
+  }
+
+  // approximate heap footprint of the per-client tables
+  size_t
+  GetStateBytes() const
+  {
+    size_t bytes = m_segmentNums.size() * (sizeof(std::pair<uint32_t, uint32_t>) + 32);
+    for (const auto& p : m_pending) {
+      bytes += sizeof(p) + 32 + p.first.size();
+    }
+    bytes += m_prefixes.size() * (sizeof(app::SegmentNameTemplate) + 128);
+    return bytes;
+  }
+
+protected:
+  virtual void
+  StartApplication() override
+  {
+    ndn::App::StartApplication();
+    m_id = std::to_string(GetNode()->GetId());
+    readTrace();
+  }
+
+  virtual void
+  StopApplication() override
+  {
+    for (auto& p : m_pending) {
+      Simulator::Cancel(p.second.timeout);
+    }
+    m_pending.clear();
+    ndn::App::StopApplication();
+  }
+
+private:
+  enum SendKind : uint8_t {
+    TRACE_SEND,    // pipeline Interest of a trace record
+    NEXT_SEGMENT,  // Interest triggered by an arriving Data
+    RETRANSMIT     // Interest re-sent after a timeout
+  };
+
+  // everything a scheduled send needs; the Interest itself is built at send time.
+  // record is the init nonce of the trace record, nonce the one on the wire
+  struct SendEvent
+  {
+    uint32_t prefix;
+    uint32_t record;
+    uint32_t nonce;
+    uint32_t segment;
+    SendKind kind;
+  };
+
+  struct Pending
+  {
+    uint32_t prefix;
+    uint32_t record;
+    uint32_t nonce;
+    uint32_t segment;
+    EventId timeout;
+  };
+
+  void
+  readTrace()
+  {
+    auto fileName = m_dict + m_ip + ".client.txt";
+    std::cout << "Starting Simulation at " << Simulator::Now().GetSeconds() << " filename " << fileName << std::endl;
+    app::LlnlTraceParser parser({3, 9, 14});
+    parser.Open(fileName);
+    long base = std::stol(m_timestamp);
+    size_t nRecords = 0;
+    auto thinner = app::LlnlWorkloadScaling::Get().MakeThinner(m_ip);
+
+    while (parser.Next()) {
+      if (!parser.Line().contains(m_ip)) {
+        continue;
+      }
+      double sizeValue;
+      long requestTime;
+      if (!app::LlnlTraceParser::ParseDouble(parser.Get(2), sizeValue) ||
+          !app::LlnlTraceParser::ParseLong(parser.Get(1), requestTime)) {
+        parser.ReportError("bad request time or data size");
+        continue;
+      }
+      std::string dataName = parser.Get(0).str();
+
+      auto data_size = static_cast<float>(sizeValue);
+      if (data_size == -2 || !thinner.keep(dataName)) {
+        continue;
+      }
+      auto time = app::LlnlWorkloadScaling::Get().ScaleTime(requestTime - base);
+      auto fireAt = Simulator::Now() + Seconds(time);
+      if (fireAt < m_windowBegin || fireAt >= m_windowEnd) {
+        continue;
+      }
+
+      auto maxSegment = std::ceil(data_size / m_segmentSize);
+      if (maxSegment <= 0) {
+        maxSegment = 1;
+      }
+      uint32_t prefix = internPrefix(dataName, maxSegment, data_size);
+      uint32_t nonce = m_rand->GetValue(0, std::numeric_limits<uint32_t>::max());
+      uint32_t pipeline = std::min(static_cast<uint32_t>(maxSegment), m_pipelineSize);
+      m_segmentNums[nonce] = pipeline;
+
+      for (uint32_t segmentNum = 0; segmentNum < pipeline; segmentNum++) {
+        Simulator::Schedule(Seconds(time), &LlnlNativeConsumer::SendInterest, this,
+                            SendEvent{prefix, nonce, nonce, segmentNum, TRACE_SEND});
+      }
+      nRecords++;
+    }
+    parser.PrintErrors(std::cout, fileName);
+    std::cout << "IP = " << m_ip << " ID = " << m_id << " scheduled " << nRecords << " records over "
+              << m_prefixes.size() << " datasets" << std::endl;
+  }
+
+  uint32_t
+  internPrefix(const std::string& dataName, uint32_t maxSegment, double dataSize)
+  {
+    auto result = m_prefixIds.emplace(dataName + "\t" + std::to_string(maxSegment), m_prefixes.size());
+    if (result.second) {
+      ::ndn::Name dataset("/cmip5/app/" + dataName);
+      LlnlPayloadSizes::Get().Register(dataset, dataSize);
+      m_prefixes.push_back(app::SegmentNameTemplate(dataset.appendSegment(maxSegment)));
+      if (app::LlnlHeavyHitters::Get().IsEnabled()) {
+        m_datasets.push_back(std::make_pair(app::datasetKey(dataset.getPrefix(-1)),
+                                            static_cast<uint64_t>(std::max(0.0, dataSize))));
+      }
+    }
+    return result.first->second;
+  }
+
+  // lookup key of an Interest name: the wire encoding of its components
+  static std::string
+  nameKey(const ::ndn::Name& name, size_t nComponents)
+  {
+    std::string key;
+    for (size_t i = 0; i < nComponents; i++) {
+      const auto& component = name.get(i);
+      key.append(reinterpret_cast<const char*>(component.wire()), component.size());
+    }
+    return key;
+  }
+
+  void
+  SendInterest(SendEvent ev)
+  {
+    if (!m_active) {
+      return;
+    }
+
+    auto& nameTemplate = m_prefixes[ev.prefix];
+    auto interest = std::make_shared<::ndn::Interest>(nameTemplate.make(ev.segment));
+    const ::ndn::Name& name = interest->getName();
+
+    uint32_t nonce = ev.nonce;
+    switch (ev.kind) {
+    case TRACE_SEND:
+      interest->setInterestLifetime(::ndn::time::seconds(100000));
+      interest->setMustBeFresh(true);
+      break;
+    case NEXT_SEGMENT:
+      break;
+    case RETRANSMIT:
+      nonce = m_rand->GetValue(0, std::numeric_limits<uint32_t>::max());
+      interest->setInterestLifetime(::ndn::time::seconds(1));
+      interest->setMustBeFresh(true);
+      break;
+    }
+    interest->setNonce(nonce);
+
+    auto timeout = Simulator::Schedule(MilliSeconds(interest->getInterestLifetime().count()),
+                                       &LlnlNativeConsumer::OnTimeout, this,
+                                       SendEvent{ev.prefix, ev.record, nonce, ev.segment, RETRANSMIT});
+    m_pending.emplace(nameTemplate.key(ev.segment), Pending{ev.prefix, ev.record, nonce, ev.segment, timeout});
+
+    auto& metrics = app::LlnlRunMetrics::Get();
+    if (metrics.IsCounting(Simulator::Now().GetNanoSeconds())) {
+      metrics.interests++;
+      if (ev.kind == TRACE_SEND && ev.segment == 0) {
+        metrics.requests++;
+      }
+    }
+    if (ev.kind == TRACE_SEND && ev.segment == 0 && ev.prefix < m_datasets.size()) {
+      app::LlnlHeavyHitters::Get().Add(Simulator::Now().GetNanoSeconds(), m_id, m_datasets[ev.prefix].first,
+                                       m_datasets[ev.prefix].second);
+    }
+
+    m_transmittedInterests(interest, this, m_face);
+    m_appLink->onReceiveInterest(*interest);
+
+    auto now = Simulator::Now().To(Time::S);
+    std::cout << "Time: " << now << ",node:" << m_id << ",func:Consumer:delayedInterest" << ",IP:" << m_ip
+              << ",Interest Name " << name << " Nonce " << nonce << std::endl;
+  }
+
+  virtual void
+  OnData(shared_ptr<const ::ndn::Data> data) override
+  {
+    if (!m_active) {
+      return;
+    }
+    ndn::App::OnData(data);
+
+    // the Data name may carry one component more than the Interest name
+    const ::ndn::Name& dataName = data->getName();
+    auto range = m_pending.equal_range(nameKey(dataName, dataName.size()));
+    if (range.first == range.second && dataName.size() > 1) {
+      range = m_pending.equal_range(nameKey(dataName, dataName.size() - 1));
+    }
+    if (range.first == range.second) {
+      return;
+    }
+
+    std::vector<Pending> satisfied;
+    for (auto it = range.first; it != range.second; ++it) {
+      Simulator::Cancel(it->second.timeout);
+      satisfied.push_back(it->second);
+    }
+    m_pending.erase(range.first, range.second);
+
+    for (const auto& pending : satisfied) {
+      onSegment(*data, pending);
+    }
+  }
+
+  // same request logic as LlnlConsumerWithTimer::onData
+  void
+  onSegment(const ::ndn::Data& data, const Pending& pending)
+  {
+    long now_in_sec = Simulator::Now().GetSeconds();
+    auto now = Simulator::Now().To(Time::S);
+    auto hopCountTag = data.getTag<::ndn::lp::HopCountTag>();
+
+    auto& metrics = app::LlnlRunMetrics::Get();
+    if (metrics.IsCounting(Simulator::Now().GetNanoSeconds())) {
+      metrics.data++;
+      if (hopCountTag != nullptr) {
+        metrics.AddHopCount(*hopCountTag);
+      }
+    }
+
+    std::cout << "Time: " << now << ",node:" << m_id << ",func:Consumer:onData" << ",IP:" << m_ip
+              << " ,Interest Nonce " << pending.nonce << " ,Data Name " << data.getName()
+              << ",Hop Count " << (hopCountTag != nullptr ? static_cast<uint64_t>(*hopCountTag) : 0) << std::endl;
+
+    uint64_t maxSeg = 0;
+    try {
+      maxSeg = data.getName().get(-3).toNumber();
+    }
+    catch (std::exception& e) {
+      std::cout << "Passing bad segment number" << data.getName() << e.what() << std::endl;
+    }
+
+    // a retransmitted Interest has a fresh nonce but still advances its record
+    auto requested = m_segmentNums.find(pending.record);
+    if (requested == m_segmentNums.end()) {
+      return;
+    }
+    uint64_t nextSeg;
+    if (app::DownloadProgress::NextSegment(requested->second, maxSeg, nextSeg)) {
+      Simulator::Schedule(Seconds(now_in_sec), &LlnlNativeConsumer::SendInterest, this,
+                          SendEvent{pending.prefix, pending.record, pending.record, static_cast<uint32_t>(nextSeg),
+                                    NEXT_SEGMENT});
+    }
+    if (maxSeg > 0 && requested->second >= maxSeg) {
+      m_segmentNums.erase(requested);
+    }
+  }
+
+  void
+  OnTimeout(SendEvent ev)
+  {
+    auto& nameTemplate = m_prefixes[ev.prefix];
+    auto range = m_pending.equal_range(nameTemplate.key(ev.segment));
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second.nonce == ev.nonce) {
+        m_pending.erase(it);
+        break;
+      }
+    }
+
+    if (app::LlnlRunMetrics::Get().IsCounting(Simulator::Now().GetNanoSeconds())) {
+      app::LlnlRunMetrics::Get().timeouts++;
+    }
+    auto now = Simulator::Now().To(Time::S);
+    std::cout << "Time: " << now << ",node:" << m_id << ",func:Consumer:onTimeout" << ",IP:" << m_ip
+              << ",Interest Name " << nameTemplate.make(ev.segment) << std::endl;
+
+    Simulator::Schedule(Seconds(1), &LlnlNativeConsumer::SendInterest, this, ev);
+  }
+
+  virtual void
+  OnNack(shared_ptr<const ::ndn::lp::Nack> nack) override
+  {
+    ndn::App::OnNack(nack);
+
+    const ::ndn::Interest& interest = nack->getInterest();
+    auto range = m_pending.equal_range(nameKey(interest.getName(), interest.getName().size()));
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second.nonce == interest.getNonce()) {
+        Simulator::Cancel(it->second.timeout);
+        m_pending.erase(it);
+        break;
+      }
+    }
+
+    if (app::LlnlRunMetrics::Get().IsCounting(Simulator::Now().GetNanoSeconds())) {
+      app::LlnlRunMetrics::Get().nacks++;
+    }
+    auto now = Simulator::Now().To(Time::S);
+    std::cout << "Time: " << now << ",node:" << m_id << ",func:Consumer:onNack" << ",IP:" << m_ip
+              << ",Interest Name " << interest.getName() << " Reason " << nack->getReason() << std::endl;
+  }
+
+private:
+  std::string m_ip;
+  std::string m_id;
+  std::string m_dict;
+  std::string m_timestamp;
+  Time m_windowBegin;
+  Time m_windowEnd;
+  Ptr<UniformRandomVariable> m_rand;
+
+  uint32_t m_pipelineSize = 64; //minimum 2
+  uint32_t m_segmentSize = 100000000; //100MB
+
+  // dataset name + max segment, interned once per dataset
+  std::unordered_map<std::string, uint32_t> m_prefixIds;
+  std::vector<app::SegmentNameTemplate> m_prefixes;
+  // dataset name and size of each prefix, kept only for the heavy hitters
+  std::vector<std::pair<std::string, uint64_t>> m_datasets;
+  //init nonce, latest segment; kept until all of the record's segments are asked for
+  std::unordered_map<uint32_t, uint32_t> m_segmentNums;
+  // Interests in flight, by name
+  std::unordered_multimap<std::string, Pending> m_pending;
+};
+
+} // namespace ns3
+
+#endif // LLNL_NATIVE_CONSUMER_HPP
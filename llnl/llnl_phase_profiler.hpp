@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_phase_profiler.hpp
+//
+// Wall-clock and memory profile of the phases of a scenario. Start(name) ends the
+// running phase and begins the next one; for each phase the wall time, the
+// resident set at its end and the process peak RSS at its end are kept. The
+// report is printed and can be written as JSON:
+//
+//   {"total_wall_sec": ..., "peak_rss_kb": ...,
+//    "phases": [{"name": ..., "wall_sec": ..., "rss_kb": ..., "peak_rss_kb": ...}, ...]}
+
+#ifndef LLNL_PHASE_PROFILER_HPP
+#define LLNL_PHASE_PROFILER_HPP
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class LlnlPhaseProfiler
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Phase
+  {
+    std::string name;
+    double wall;
+    long rss;     // KB at the end of the phase
+    long peakRss; // KB, process peak at the end of the phase
+  };
+
+  LlnlPhaseProfiler()
+    : m_begin(Clock::now())
+    , m_phaseBegin(m_begin)
+  {
+  }
+
+  void
+  Start(const std::string& name)
+  {
+    Stop();
+    m_current = name;
+    m_phaseBegin = Clock::now();
+  }
+
+  void
+  Stop()
+  {
+    if (m_current.empty()) {
+      return;
+    }
+    double wall = std::chrono::duration<double>(Clock::now() - m_phaseBegin).count();
+    m_phases.push_back(Phase{m_current, wall, GetRss(), GetPeakRss()});
+    m_current.clear();
+  }
+
+  void
+  Print(std::ostream& os) const
+  {
+    os << "Phase profile" << std::endl;
+    for (const auto& phase : m_phases) {
+      os << "  " << phase.name << ": " << phase.wall << "s, rss " << phase.rss / 1024 << "MB, peak "
+         << phase.peakRss / 1024 << "MB" << std::endl;
+    }
+  }
+
+  bool
+  Write(const std::string& fileName) const
+  {
+    std::ofstream os(fileName);
+    os << "{\"total_wall_sec\": " << std::chrono::duration<double>(Clock::now() - m_begin).count()
+       << ", \"peak_rss_kb\": " << GetPeakRss() << ", \"phases\": [";
+    for (size_t i = 0; i < m_phases.size(); i++) {
+      const Phase& phase = m_phases[i];
+      os << (i == 0 ? "" : ", ") << "{\"name\": \"" << phase.name << "\", \"wall_sec\": " << phase.wall
+         << ", \"rss_kb\": " << phase.rss << ", \"peak_rss_kb\": " << phase.peakRss << "}";
+    }
+    os << "]}\n";
+    return static_cast<bool>(os);
+  }
+
+  // current resident set size in KB
+  static long
+  GetRss()
+  {
+    long pages = 0;
+    std::ifstream statm("/proc/self/statm");
+    statm >> pages >> pages;
+    return pages * (sysconf(_SC_PAGESIZE) / 1024);
+  }
+
+  static long
+  GetPeakRss()
+  {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+  }
+
+private:
+  Clock::time_point m_begin;
+  Clock::time_point m_phaseBegin;
+  std::string m_current;
+  std::vector<Phase> m_phases;
+};
+
+} // namespace ns3
+
+#endif // LLNL_PHASE_PROFILER_HPP
@@ -0,0 +1,429 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_replica_placement.hpp
+//
+// Offline placement of dataset replicas on the servers. The demand is the number of
+// requests each client makes for each dataset in a trace week, the cost of a
+// request is the hop distance from its client to the closest server holding the
+// dataset, and every server stores at most its capacity in bytes.
+//
+// Placement is greedy: datasets, most requested first, get a home on the server
+// that minimises their cost among those with room left; then extra replicas are
+// added in order of cost saved per byte (lazily re-evaluated, as the saving of a
+// replica only shrinks when other replicas of the same dataset are added) until no
+// replica fits or saves anything.
+//
+// Placement files have one "<dataset> <server> [<server> ...]" line per dataset.
+
+#ifndef LLNL_REPLICA_PLACEMENT_HPP
+#define LLNL_REPLICA_PLACEMENT_HPP
+
+#include <boost/algorithm/string.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace app {
+
+class LlnlReplicaPlacement
+{
+public:
+    enum : uint32_t { UNREACHABLE = std::numeric_limits<uint32_t>::max() };
+
+    // node names from the link section of an annotated topology
+    bool
+    ReadTopology(const std::string& fileName)
+    {
+        std::ifstream is(fileName);
+        if (!is) {
+            return false;
+        }
+        bool links = false;
+        std::string line;
+        while (getline(is, line)) {
+            std::istringstream ss(line);
+            std::string from, to;
+            if (!(ss >> from) || from[0] == '#') {
+                continue;
+            }
+            if (from == "router" || from == "link") {
+                links = from == "link";
+                continue;
+            }
+            if (links && (ss >> to)) {
+                size_t a = nodeIndex(from);
+                size_t b = nodeIndex(to);
+                m_adj[a].push_back(b);
+                m_adj[b].push_back(a);
+            }
+        }
+        return true;
+    }
+
+    void
+    AddServer(const std::string& name, double capacity)
+    {
+        m_servers.push_back(Server{name, capacity, 0, {}});
+    }
+
+    // requests of one client, from its "<dict><ip>.client.txt" trace file
+    bool
+    ReadClientTrace(const std::string& ip, const std::string& fileName)
+    {
+        std::ifstream is(fileName);
+        if (!is) {
+            return false;
+        }
+        uint32_t client = clientIndex(ip);
+        std::string line;
+        std::vector<std::string> parts;
+        while (getline(is, line)) {
+            if (line.find(ip) == std::string::npos) {
+                continue;
+            }
+            boost::split(parts, line, boost::is_any_of("\t"));
+            if (parts.size() < 15) {
+                continue;
+            }
+            double size = std::atof(parts[14].c_str());
+            if (size < 0) {
+                continue;
+            }
+            Dataset& dataset = m_datasets[datasetIndex(parts[3])];
+            dataset.size = std::max(dataset.size, size);
+            dataset.requests++;
+            dataset.demand[client]++;
+        }
+        return true;
+    }
+
+    void
+    Optimise()
+    {
+        computeDistances();
+        for (auto& dataset : m_datasets) {
+            dataset.clients.clear();
+            for (const auto& demand : dataset.demand) {
+                dataset.clients.push_back(std::make_pair(demand.first, demand.second));
+            }
+            dataset.best.assign(dataset.clients.size(), UNREACHABLE);
+            dataset.replicas.clear();
+        }
+
+        // a home for every dataset, most requested first
+        std::vector<size_t> order(m_datasets.size());
+        for (size_t d = 0; d < order.size(); d++) {
+            order[d] = d;
+        }
+        std::sort(order.begin(), order.end(), [this] (size_t a, size_t b) {
+            return m_datasets[a].requests > m_datasets[b].requests;
+        });
+        for (size_t d : order) {
+            size_t home = m_servers.size();
+            double homeCost = 0;
+            for (size_t s = 0; s < m_servers.size(); s++) {
+                if (!fits(d, s)) {
+                    continue;
+                }
+                double cost = costWith(d, s);
+                if (home == m_servers.size() || cost < homeCost) {
+                    home = s;
+                    homeCost = cost;
+                }
+            }
+            if (home < m_servers.size()) {
+                place(d, home);
+            }
+        }
+
+        // extra replicas by saving per byte
+        typedef std::pair<double, std::pair<size_t, size_t>> Candidate;
+        std::priority_queue<Candidate> candidates;
+        for (size_t d = 0; d < m_datasets.size(); d++) {
+            for (size_t s = 0; s < m_servers.size(); s++) {
+                if (!m_datasets[d].replicas.empty() && fits(d, s)) {
+                    double gain = perByte(d, saving(d, s));
+                    if (gain > 0) {
+                        candidates.push(Candidate(gain, std::make_pair(d, s)));
+                    }
+                }
+            }
+        }
+        while (!candidates.empty()) {
+            Candidate top = candidates.top();
+            candidates.pop();
+            size_t d = top.second.first;
+            size_t s = top.second.second;
+            if (!fits(d, s)) {
+                continue;
+            }
+            double gain = perByte(d, saving(d, s));
+            if (gain <= 0) {
+                continue;
+            }
+            if (!candidates.empty() && gain < candidates.top().first) {
+                candidates.push(Candidate(gain, top.second));
+                continue;
+            }
+            place(d, s);
+        }
+    }
+
+    bool
+    Write(const std::string& fileName) const
+    {
+        std::ofstream os(fileName);
+        for (const auto& dataset : m_datasets) {
+            if (dataset.replicas.empty()) {
+                continue;
+            }
+            os << dataset.name;
+            for (size_t s : dataset.replicas) {
+                os << "\t" << m_servers[s].name;
+            }
+            os << "\n";
+        }
+        return static_cast<bool>(os);
+    }
+
+    void
+    PrintSummary(std::ostream& os) const
+    {
+        double requests = 0, placed = 0, replicaCost = 0, fullCost = 0;
+        size_t replicas = 0, unplaced = 0;
+        for (const auto& dataset : m_datasets) {
+            requests += dataset.requests;
+            replicas += dataset.replicas.size();
+            if (dataset.replicas.empty()) {
+                unplaced++;
+                continue;
+            }
+            placed += dataset.requests;
+            for (size_t i = 0; i < dataset.clients.size(); i++) {
+                uint32_t full = UNREACHABLE;
+                for (size_t s = 0; s < m_servers.size(); s++) {
+                    full = std::min(full, distance(s, dataset.clients[i].first));
+                }
+                if (dataset.best[i] != UNREACHABLE && full != UNREACHABLE) {
+                    replicaCost += dataset.clients[i].second * static_cast<double>(dataset.best[i]);
+                    fullCost += dataset.clients[i].second * static_cast<double>(full);
+                }
+            }
+        }
+        os << "Replica placement: " << m_datasets.size() << " datasets, " << requests << " requests, "
+           << replicas << " replicas, " << unplaced << " datasets without room" << std::endl;
+        os << "Replica placement: mean hops " << (placed > 0 ? replicaCost / placed : 0)
+           << ", with every dataset on every server " << (placed > 0 ? fullCost / placed : 0) << std::endl;
+        for (const auto& server : m_servers) {
+            os << "  " << server.name << ": " << server.datasets.size() << " datasets, " << server.used
+               << " of " << server.capacity << " bytes" << std::endl;
+        }
+    }
+
+    // dataset to the servers holding it
+    static std::map<std::string, std::vector<std::string>>
+    ReadPlacement(const std::string& fileName)
+    {
+        std::map<std::string, std::vector<std::string>> placement;
+        std::ifstream is(fileName);
+        std::string line;
+        while (getline(is, line)) {
+            std::istringstream ss(line);
+            std::string dataset, server;
+            if (!(ss >> dataset) || dataset[0] == '#') {
+                continue;
+            }
+            while (ss >> server) {
+                placement[dataset].push_back(server);
+            }
+        }
+        return placement;
+    }
+
+private:
+    struct Server
+    {
+        std::string name;
+        double capacity; // bytes
+        double used;
+        std::vector<size_t> datasets;
+    };
+
+    struct Dataset
+    {
+        std::string name;
+        double size = 0;
+        uint64_t requests = 0;
+        std::unordered_map<uint32_t, uint64_t> demand;       // client -> requests
+        std::vector<std::pair<uint32_t, uint64_t>> clients; // demand, in a fixed order
+        std::vector<uint32_t> best;                          // hops to the closest replica, per client
+        std::vector<size_t> replicas;
+    };
+
+    size_t
+    nodeIndex(const std::string& name)
+    {
+        auto result = m_nodes.emplace(name, m_adj.size());
+        if (result.second) {
+            m_adj.push_back({});
+        }
+        return result.first->second;
+    }
+
+    uint32_t
+    clientIndex(const std::string& ip)
+    {
+        auto result = m_clients.emplace(ip, m_clientNames.size());
+        if (result.second) {
+            m_clientNames.push_back(ip);
+        }
+        return result.first->second;
+    }
+
+    size_t
+    datasetIndex(const std::string& name)
+    {
+        auto result = m_datasetIndex.emplace(name, m_datasets.size());
+        if (result.second) {
+            m_datasets.push_back(Dataset());
+            m_datasets.back().name = name;
+        }
+        return result.first->second;
+    }
+
+    // hop distances from every server to every client, by BFS
+    void
+    computeDistances()
+    {
+        m_distances.assign(m_servers.size(), std::vector<uint32_t>(m_clientNames.size(), UNREACHABLE));
+        std::vector<uint32_t> hops(m_adj.size());
+        for (size_t s = 0; s < m_servers.size(); s++) {
+            auto source = m_nodes.find(m_servers[s].name);
+            if (source == m_nodes.end()) {
+                continue;
+            }
+            std::fill(hops.begin(), hops.end(), UNREACHABLE);
+            std::queue<size_t> queue;
+            hops[source->second] = 0;
+            queue.push(source->second);
+            while (!queue.empty()) {
+                size_t v = queue.front();
+                queue.pop();
+                for (size_t w : m_adj[v]) {
+                    if (hops[w] == UNREACHABLE) {
+                        hops[w] = hops[v] + 1;
+                        queue.push(w);
+                    }
+                }
+            }
+            for (size_t c = 0; c < m_clientNames.size(); c++) {
+                auto node = m_nodes.find(m_clientNames[c]);
+                if (node != m_nodes.end()) {
+                    m_distances[s][c] = hops[node->second];
+                }
+            }
+        }
+    }
+
+    uint32_t
+    distance(size_t server, uint32_t client) const
+    {
+        return m_distances[server][client];
+    }
+
+    bool
+    fits(size_t d, size_t s) const
+    {
+        const Dataset& dataset = m_datasets[d];
+        return m_servers[s].used + dataset.size <= m_servers[s].capacity &&
+               std::find(dataset.replicas.begin(), dataset.replicas.end(), s) == dataset.replicas.end();
+    }
+
+    // request-weighted hops of a dataset with only server s holding it
+    double
+    costWith(size_t d, size_t s) const
+    {
+        const Dataset& dataset = m_datasets[d];
+        double cost = 0;
+        for (const auto& client : dataset.clients) {
+            uint32_t hops = distance(s, client.first);
+            // an unreachable client costs more than any path
+            cost += client.second * (hops == UNREACHABLE ? static_cast<double>(m_adj.size()) : hops);
+        }
+        return cost;
+    }
+
+    // request-weighted hops saved by adding server s to the replicas
+    double
+    saving(size_t d, size_t s) const
+    {
+        const Dataset& dataset = m_datasets[d];
+        double saved = 0;
+        for (size_t i = 0; i < dataset.clients.size(); i++) {
+            uint32_t hops = distance(s, dataset.clients[i].first);
+            if (hops < dataset.best[i]) {
+                saved += dataset.clients[i].second * static_cast<double>(dataset.best[i] - hops);
+            }
+        }
+        return saved;
+    }
+
+    double
+    perByte(size_t d, double saved) const
+    {
+        return saved / std::max(1.0, m_datasets[d].size);
+    }
+
+    void
+    place(size_t d, size_t s)
+    {
+        Dataset& dataset = m_datasets[d];
+        dataset.replicas.push_back(s);
+        for (size_t i = 0; i < dataset.clients.size(); i++) {
+            dataset.best[i] = std::min(dataset.best[i], distance(s, dataset.clients[i].first));
+        }
+        m_servers[s].used += dataset.size;
+        m_servers[s].datasets.push_back(d);
+    }
+
+private:
+    std::unordered_map<std::string, size_t> m_nodes;
+    std::vector<std::vector<size_t>> m_adj;
+    std::vector<Server> m_servers;
+    std::unordered_map<std::string, uint32_t> m_clients;
+    std::vector<std::string> m_clientNames;
+    std::unordered_map<std::string, size_t> m_datasetIndex;
+    std::vector<Dataset> m_datasets;
+    std::vector<std::vector<uint32_t>> m_distances; // [server][client]
+};
+
+} // namespace app
+
+#endif // LLNL_REPLICA_PLACEMENT_HPP
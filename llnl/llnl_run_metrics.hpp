@@ -0,0 +1,163 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_run_metrics.hpp
+//
+// Run-wide consumer counters. Only events inside the measurement window are
+// counted, so time-window shards can leave their warm-up out and the per-window
+// files can simply be added up. Files are "<key> <value>" lines, plus one
+// "hops <count> <packets>" line per hop-count bucket.
+
+#ifndef LLNL_RUN_METRICS_HPP
+#define LLNL_RUN_METRICS_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace app {
+
+class LlnlRunMetrics
+{
+public:
+    static const size_t MAX_HOPS = 64; // last bucket collects everything above
+
+    LlnlRunMetrics()
+        : hops(MAX_HOPS + 1, 0)
+    {
+    }
+
+    static LlnlRunMetrics&
+    Get()
+    {
+        static LlnlRunMetrics instance;
+        return instance;
+    }
+
+    // measurement window in simulated ns, [begin, end)
+    void
+    SetWindow(int64_t begin, int64_t end)
+    {
+        windowBegin = begin;
+        windowEnd = end;
+    }
+
+    bool
+    IsCounting(int64_t now) const
+    {
+        return now >= windowBegin && now < windowEnd;
+    }
+
+    void
+    AddHopCount(uint32_t hopCount)
+    {
+        hopCountSum += hopCount;
+        hops[hopCount < MAX_HOPS ? hopCount : MAX_HOPS]++;
+    }
+
+    void
+    Merge(const LlnlRunMetrics& other)
+    {
+        requests += other.requests;
+        interests += other.interests;
+        data += other.data;
+        timeouts += other.timeouts;
+        nacks += other.nacks;
+        hopCountSum += other.hopCountSum;
+        for (size_t i = 0; i < hops.size(); i++) {
+            hops[i] += other.hops[i];
+        }
+    }
+
+    void
+    Write(std::ostream& os) const
+    {
+        os << "window_begin " << windowBegin << "\n"
+           << "window_end " << windowEnd << "\n"
+           << "requests " << requests << "\n"
+           << "interests " << interests << "\n"
+           << "data " << data << "\n"
+           << "timeouts " << timeouts << "\n"
+           << "nacks " << nacks << "\n"
+           << "hop_count_sum " << hopCountSum << "\n";
+        for (size_t i = 0; i < hops.size(); i++) {
+            if (hops[i] != 0) {
+                os << "hops " << i << " " << hops[i] << "\n";
+            }
+        }
+    }
+
+    bool
+    Write(const std::string& fileName) const
+    {
+        std::ofstream os(fileName);
+        Write(os);
+        return static_cast<bool>(os);
+    }
+
+    bool
+    Read(const std::string& fileName)
+    {
+        std::ifstream is(fileName);
+        if (!is) {
+            return false;
+        }
+        std::string line;
+        while (getline(is, line)) {
+            std::istringstream ss(line);
+            std::string key;
+            ss >> key;
+            if (key == "window_begin") ss >> windowBegin;
+            else if (key == "window_end") ss >> windowEnd;
+            else if (key == "requests") ss >> requests;
+            else if (key == "interests") ss >> interests;
+            else if (key == "data") ss >> data;
+            else if (key == "timeouts") ss >> timeouts;
+            else if (key == "nacks") ss >> nacks;
+            else if (key == "hop_count_sum") ss >> hopCountSum;
+            else if (key == "hops") {
+                size_t bucket;
+                uint64_t count;
+                ss >> bucket >> count;
+                hops[bucket < MAX_HOPS ? bucket : MAX_HOPS] += count;
+            }
+        }
+        return true;
+    }
+
+public:
+    int64_t windowBegin = 0;
+    int64_t windowEnd = std::numeric_limits<int64_t>::max();
+
+    uint64_t requests = 0;
+    uint64_t interests = 0;
+    uint64_t data = 0;
+    uint64_t timeouts = 0;
+    uint64_t nacks = 0;
+    uint64_t hopCountSum = 0;
+    std::vector<uint64_t> hops;
+};
+
+} // namespace app
+
+#endif // LLNL_RUN_METRICS_HPP
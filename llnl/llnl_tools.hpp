@@ -0,0 +1,80 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_tools.hpp
+//
+// Helpers shared by the command-line tools (llnl_compare, llnl_log_analyzer,
+// llnl_replica_placement, llnl_shard_runner): "--name=value" options and hop-count
+// statistics of a run's metrics.
+
+#ifndef LLNL_TOOLS_HPP
+#define LLNL_TOOLS_HPP
+
+#include "llnl_run_metrics.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace app {
+
+// value of arg if it is --<name>=<value>
+inline bool
+parseOption(const char* arg, const char* name, std::string& value)
+{
+    std::string prefix = std::string("--") + name + "=";
+    if (std::strncmp(arg, prefix.c_str(), prefix.size()) != 0) {
+        return false;
+    }
+    value = arg + prefix.size();
+    return true;
+}
+
+inline uint64_t
+hopTotal(const LlnlRunMetrics& metrics)
+{
+    uint64_t total = 0;
+    for (uint64_t count : metrics.hops) {
+        total += count;
+    }
+    return total;
+}
+
+// hop count of the Data at rank q of all Data, from the hop-count buckets
+inline double
+hopQuantile(const LlnlRunMetrics& metrics, double q)
+{
+    uint64_t total = hopTotal(metrics);
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(q * (total - 1));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < metrics.hops.size(); i++) {
+        seen += metrics.hops[i];
+        if (seen > rank) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+} // namespace app
+
+#endif // LLNL_TOOLS_HPP
@@ -0,0 +1,546 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_topology_pruner.hpp
+//
+// Shrinks an annotated topology file before it is read, given the terminal nodes
+// (clients and producers):
+//
+//  1. pruning: only nodes that lie on some simple path between a client and a
+//     producer are kept; paths between two clients or two producers carry no
+//     Interests and are left out. These are the nodes of the biconnected blocks on
+//     the block-cut tree paths between a client and a producer: a tree node is on
+//     one if it holds a client and its tree component a producer (or the reverse),
+//     or if a client and a producer lie in two different branches around it.
+//  2. chain compaction: every chain of non-terminal degree-2 nodes between two
+//     other nodes becomes one link, with the summed delay and metric and the
+//     bandwidth and queue of its slowest link. A chain is left alone when its ends
+//     are the same node or are already linked, so no parallel links are created.
+//
+// Write() produces the pruned topology in the same format, plus a mapping file
+// with one "<node> kept|pruned|compacted <where>" line per original node; for
+// compacted nodes <where> is the "<a>-<b>" link that replaced their chain.
+
+#ifndef LLNL_TOPOLOGY_PRUNER_HPP
+#define LLNL_TOPOLOGY_PRUNER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace app {
+
+class LlnlTopologyPruner
+{
+public:
+    bool
+    Read(const std::string& fileName)
+    {
+        std::ifstream is(fileName);
+        if (!is) {
+            return false;
+        }
+        enum { NONE, ROUTERS, LINKS } section = NONE;
+        std::string line;
+        while (getline(is, line)) {
+            std::istringstream ss(line);
+            std::string first;
+            if (!(ss >> first) || first[0] == '#') {
+                continue;
+            }
+            if (first == "router") {
+                section = ROUTERS;
+                continue;
+            }
+            if (first == "link") {
+                section = LINKS;
+                continue;
+            }
+            if (section == ROUTERS) {
+                nodeIndex(first);
+                m_nodes[m_index[first]].line = line;
+            }
+            else if (section == LINKS) {
+                Link link;
+                std::string metric, delay;
+                ss >> link.to >> link.bandwidth >> metric >> delay >> link.queue;
+                link.from = first;
+                link.metric = metric.empty() ? 1 : std::atol(metric.c_str());
+                link.delay = parseDelay(delay);
+                link.line = line;
+                size_t id = m_links.size();
+                m_links.push_back(link);
+                size_t a = nodeIndex(link.from);
+                size_t b = nodeIndex(link.to);
+                m_adj[a].push_back(std::make_pair(b, id));
+                m_adj[b].push_back(std::make_pair(a, id));
+            }
+        }
+        return true;
+    }
+
+    enum Role {
+        CLIENT = 1,
+        PRODUCER = 2
+    };
+
+    // terminals that are not in the topology are ignored
+    void
+    AddTerminal(const std::string& name, Role role)
+    {
+        m_terminalNames.push_back(std::make_pair(name, role));
+    }
+
+    // one node name per line, as in the clients and servers files
+    bool
+    ReadTerminals(const std::string& fileName, Role role)
+    {
+        std::ifstream is(fileName);
+        std::string line;
+        while (getline(is, line)) {
+            AddTerminal(line, role);
+        }
+        return !is.bad() && is.eof();
+    }
+
+    void
+    Prune()
+    {
+        m_terminal.assign(m_nodes.size(), 0);
+        for (const auto& terminal : m_terminalNames) {
+            auto it = m_index.find(terminal.first);
+            if (it != m_index.end()) {
+                m_terminal[it->second] |= terminal.second;
+            }
+        }
+        findBlocks();
+        pruneBlockCutTree();
+        compactChains();
+    }
+
+    bool
+    Write(const std::string& topologyFile, const std::string& mappingFile) const
+    {
+        std::ofstream os(topologyFile);
+        os << "router\n";
+        for (size_t v = 0; v < m_nodes.size(); v++) {
+            if (m_nodes[v].state == KEPT) {
+                os << (m_nodes[v].line.empty() ? m_nodes[v].name : m_nodes[v].line) << "\n";
+            }
+        }
+        os << "\nlink\n";
+        for (const auto& link : m_links) {
+            if (link.kept) {
+                os << link.line << "\n";
+            }
+        }
+        for (const auto& link : m_compacted) {
+            os << link.from << "\t" << link.to << "\t" << link.bandwidth << "\t" << link.metric << "\t"
+               << formatDelay(link.delay) << (link.queue.empty() ? "" : "\t") << link.queue << "\n";
+        }
+
+        std::ofstream map(mappingFile);
+        static const char* states[] = {"pruned", "kept", "compacted"};
+        for (const auto& node : m_nodes) {
+            map << node.name << "\t" << states[node.state] << "\t"
+                << (node.state == KEPT ? node.name : node.state == PRUNED ? "-" : node.replacedBy) << "\n";
+        }
+        return static_cast<bool>(os) && static_cast<bool>(map);
+    }
+
+    void
+    PrintSummary(std::ostream& os) const
+    {
+        size_t kept = 0, compacted = 0, keptLinks = 0;
+        for (const auto& node : m_nodes) {
+            kept += node.state == KEPT;
+            compacted += node.state == COMPACTED;
+        }
+        for (const auto& link : m_links) {
+            keptLinks += link.kept;
+        }
+        os << "Topology pruning: " << m_nodes.size() << " nodes, " << m_links.size() << " links -> "
+           << kept << " nodes, " << keptLinks + m_compacted.size() << " links (" << compacted
+           << " nodes in compacted chains, " << m_nodes.size() - kept - compacted << " pruned)" << std::endl;
+    }
+
+private:
+    enum State { PRUNED, KEPT, COMPACTED };
+
+    struct Node
+    {
+        std::string name;
+        std::string line;
+        State state = PRUNED;
+        std::string replacedBy;
+    };
+
+    struct Link
+    {
+        std::string from;
+        std::string to;
+        std::string bandwidth;
+        long metric = 1;
+        int64_t delay = 0; // ns
+        std::string queue;
+        std::string line;
+        bool kept = false;
+        size_t block = 0;
+    };
+
+    size_t
+    nodeIndex(const std::string& name)
+    {
+        auto result = m_index.emplace(name, m_nodes.size());
+        if (result.second) {
+            m_nodes.push_back(Node());
+            m_nodes.back().name = name;
+            m_adj.push_back({});
+        }
+        return result.first->second;
+    }
+
+    // biconnected blocks by an iterative Tarjan DFS; each link gets its block
+    void
+    findBlocks()
+    {
+        size_t n = m_nodes.size();
+        const size_t NONE = static_cast<size_t>(-1);
+        std::vector<size_t> disc(n, NONE), low(n, 0);
+        std::vector<size_t> edgeStack;
+        struct Frame { size_t v; size_t parentEdge; size_t pos; };
+        std::vector<Frame> frames;
+        size_t timer = 0;
+        m_blocks.clear();
+
+        for (size_t root = 0; root < n; root++) {
+            if (disc[root] != NONE) {
+                continue;
+            }
+            disc[root] = low[root] = timer++;
+            frames.push_back(Frame{root, NONE, 0});
+            while (!frames.empty()) {
+                Frame& f = frames.back();
+                size_t v = f.v;
+                if (f.pos < m_adj[v].size()) {
+                    size_t w = m_adj[v][f.pos].first;
+                    size_t e = m_adj[v][f.pos].second;
+                    f.pos++;
+                    if (e == f.parentEdge) {
+                        continue;
+                    }
+                    if (disc[w] == NONE) {
+                        edgeStack.push_back(e);
+                        disc[w] = low[w] = timer++;
+                        frames.push_back(Frame{w, e, 0});
+                    }
+                    else if (disc[w] < disc[v]) {
+                        edgeStack.push_back(e);
+                        low[v] = std::min(low[v], disc[w]);
+                    }
+                    continue;
+                }
+                size_t parentEdge = f.parentEdge;
+                frames.pop_back();
+                if (frames.empty()) {
+                    break;
+                }
+                size_t u = frames.back().v;
+                low[u] = std::min(low[u], low[v]);
+                if (low[v] >= disc[u]) {
+                    std::set<size_t> block;
+                    size_t e;
+                    do {
+                        e = edgeStack.back();
+                        edgeStack.pop_back();
+                        m_links[e].block = m_blocks.size();
+                        block.insert(m_index[m_links[e].from]);
+                        block.insert(m_index[m_links[e].to]);
+                    } while (e != parentEdge);
+                    m_blocks.push_back(std::vector<size_t>(block.begin(), block.end()));
+                }
+            }
+        }
+    }
+
+    // keep the block-cut tree nodes on a path between a client and a producer
+    void
+    pruneBlockCutTree()
+    {
+        size_t n = m_nodes.size();
+        size_t nBlocks = m_blocks.size();
+        std::vector<std::vector<size_t>> blocksOf(n);
+        for (size_t b = 0; b < nBlocks; b++) {
+            for (size_t v : m_blocks[b]) {
+                blocksOf[v].push_back(b);
+            }
+        }
+
+        // tree nodes: blocks are 0..nBlocks-1, cut vertex v is nBlocks + v; a tree
+        // node holds the roles of the terminals it stands for
+        std::vector<std::vector<size_t>> tree(nBlocks + n);
+        std::vector<uint8_t> roles(nBlocks + n, 0);
+        for (size_t v = 0; v < n; v++) {
+            bool cut = blocksOf[v].size() > 1;
+            if (cut) {
+                for (size_t b : blocksOf[v]) {
+                    tree[b].push_back(nBlocks + v);
+                    tree[nBlocks + v].push_back(b);
+                }
+                roles[nBlocks + v] |= m_terminal[v];
+            }
+            else if (!blocksOf[v].empty()) {
+                roles[blocksOf[v].front()] |= m_terminal[v];
+            }
+        }
+
+        // clients and producers in each tree node's subtree, per tree component
+        const size_t NONE = static_cast<size_t>(-1);
+        std::vector<size_t> parent(tree.size(), NONE);
+        std::vector<size_t> component(tree.size(), NONE);
+        std::vector<size_t> clients(tree.size(), 0), producers(tree.size(), 0);
+        std::vector<size_t> order;
+        std::vector<std::pair<size_t, size_t>> totals; // (clients, producers) per component
+        for (size_t root = 0; root < tree.size(); root++) {
+            bool present = root < nBlocks || blocksOf[root - nBlocks].size() > 1;
+            if (!present || component[root] != NONE) {
+                continue;
+            }
+            size_t first = order.size();
+            component[root] = totals.size();
+            order.push_back(root);
+            for (size_t i = first; i < order.size(); i++) {
+                for (size_t u : tree[order[i]]) {
+                    if (component[u] == NONE) {
+                        component[u] = totals.size();
+                        parent[u] = order[i];
+                        order.push_back(u);
+                    }
+                }
+            }
+            for (size_t i = order.size(); i-- > first;) {
+                size_t t = order[i];
+                clients[t] += (roles[t] & CLIENT) != 0;
+                producers[t] += (roles[t] & PRODUCER) != 0;
+                if (parent[t] != NONE) {
+                    clients[parent[t]] += clients[t];
+                    producers[parent[t]] += producers[t];
+                }
+            }
+            totals.push_back(std::make_pair(clients[root], producers[root]));
+        }
+
+        std::vector<bool> removed(tree.size(), true);
+        for (size_t t : order) {
+            const auto& total = totals[component[t]];
+            if (((roles[t] & CLIENT) && total.second > 0) || ((roles[t] & PRODUCER) && total.first > 0)) {
+                removed[t] = false;
+                continue;
+            }
+            // branches around t: its children's subtrees and the rest of the component
+            std::vector<std::pair<size_t, size_t>> branches;
+            for (size_t u : tree[t]) {
+                if (u != parent[t]) {
+                    branches.push_back(std::make_pair(clients[u], producers[u]));
+                }
+            }
+            branches.push_back(std::make_pair(total.first - clients[t], total.second - producers[t]));
+            size_t clientBranches = 0, producerBranches = 0;
+            bool both = false;
+            for (const auto& branch : branches) {
+                clientBranches += branch.first > 0;
+                producerBranches += branch.second > 0;
+                both = both || (branch.first > 0 && branch.second > 0);
+            }
+            // a client and a producer in different branches
+            removed[t] = clientBranches == 0 || producerBranches == 0 ||
+                         (clientBranches == 1 && producerBranches == 1 && both);
+        }
+
+        for (size_t b = 0; b < nBlocks; b++) {
+            if (!removed[b]) {
+                for (size_t v : m_blocks[b]) {
+                    m_nodes[v].state = KEPT;
+                }
+            }
+        }
+        for (size_t v = 0; v < n; v++) {
+            if (m_terminal[v]) {
+                m_nodes[v].state = KEPT;
+            }
+        }
+        for (auto& link : m_links) {
+            link.kept = !removed[link.block] && m_nodes[m_index[link.from]].state == KEPT &&
+                        m_nodes[m_index[link.to]].state == KEPT;
+        }
+    }
+
+    bool
+    isChainNode(size_t v, const std::vector<size_t>& degree) const
+    {
+        return m_nodes[v].state == KEPT && m_terminal[v] == 0 && degree[v] == 2;
+    }
+
+    void
+    compactChains()
+    {
+        size_t n = m_nodes.size();
+        std::vector<size_t> degree(n, 0);
+        std::set<std::pair<size_t, size_t>> linked;
+        for (const auto& link : m_links) {
+            if (link.kept) {
+                size_t a = m_index.at(link.from), b = m_index.at(link.to);
+                degree[a]++;
+                degree[b]++;
+                linked.insert(std::minmax(a, b));
+            }
+        }
+
+        std::vector<bool> visited(m_links.size(), false);
+        for (size_t a = 0; a < n; a++) {
+            if (m_nodes[a].state != KEPT || isChainNode(a, degree)) {
+                continue;
+            }
+            for (const auto& start : m_adj[a]) {
+                if (!m_links[start.second].kept || visited[start.second] || !isChainNode(start.first, degree)) {
+                    continue;
+                }
+
+                // walk to the other end of the chain
+                std::vector<size_t> chainLinks{start.second};
+                std::vector<size_t> chainNodes;
+                size_t prevLink = start.second;
+                size_t v = start.first;
+                while (isChainNode(v, degree)) {
+                    chainNodes.push_back(v);
+                    for (const auto& next : m_adj[v]) {
+                        if (m_links[next.second].kept && next.second != prevLink) {
+                            prevLink = next.second;
+                            v = next.first;
+                            break;
+                        }
+                    }
+                    chainLinks.push_back(prevLink);
+                }
+                for (size_t e : chainLinks) {
+                    visited[e] = true;
+                }
+                size_t b = v;
+                if (a == b || linked.count(std::minmax(a, b)) != 0) {
+                    continue;
+                }
+                linked.insert(std::minmax(a, b));
+
+                Link merged;
+                merged.from = m_nodes[a].name;
+                merged.to = m_nodes[b].name;
+                merged.metric = 0;
+                double slowest = -1;
+                for (size_t e : chainLinks) {
+                    const Link& link = m_links[e];
+                    merged.metric += link.metric;
+                    merged.delay += link.delay;
+                    double rate = parseRate(link.bandwidth);
+                    if (slowest < 0 || rate < slowest) {
+                        slowest = rate;
+                        merged.bandwidth = link.bandwidth;
+                        merged.queue = link.queue;
+                    }
+                    m_links[e].kept = false;
+                }
+                merged.kept = true;
+                m_compacted.push_back(merged);
+                for (size_t c : chainNodes) {
+                    m_nodes[c].state = COMPACTED;
+                    m_nodes[c].replacedBy = merged.from + "-" + merged.to;
+                }
+            }
+        }
+    }
+
+    // "10Gbps", "100Mbps", "1KBps", ... in bits per second
+    static double
+    parseRate(const std::string& rate)
+    {
+        char* end = nullptr;
+        double value = std::strtod(rate.c_str(), &end);
+        std::string unit(end);
+        double scale = 1;
+        if (!unit.empty()) {
+            switch (unit[0]) {
+            case 'k': case 'K': scale = 1e3; unit.erase(0, 1); break;
+            case 'M': scale = 1e6; unit.erase(0, 1); break;
+            case 'G': scale = 1e9; unit.erase(0, 1); break;
+            default: break;
+            }
+        }
+        if (!unit.empty() && unit[0] == 'B') {
+            scale *= 8;
+        }
+        return value * scale;
+    }
+
+    // "10ms", "5us", "1s", ... in ns
+    static int64_t
+    parseDelay(const std::string& delay)
+    {
+        if (delay.empty()) {
+            return 0;
+        }
+        char* end = nullptr;
+        double value = std::strtod(delay.c_str(), &end);
+        std::string unit(end);
+        double scale = unit == "ns" ? 1 : unit == "us" ? 1e3 : unit == "ms" ? 1e6 : 1e9;
+        return static_cast<int64_t>(value * scale + 0.5);
+    }
+
+    static std::string
+    formatDelay(int64_t ns)
+    {
+        if (ns % 1000000 == 0) {
+            return std::to_string(ns / 1000000) + "ms";
+        }
+        if (ns % 1000 == 0) {
+            return std::to_string(ns / 1000) + "us";
+        }
+        return std::to_string(ns) + "ns";
+    }
+
+private:
+    std::vector<Node> m_nodes;
+    std::unordered_map<std::string, size_t> m_index;
+    std::vector<std::vector<std::pair<size_t, size_t>>> m_adj; // (neighbour, link)
+    std::vector<Link> m_links;
+    std::vector<std::vector<size_t>> m_blocks;
+    std::vector<std::pair<std::string, Role>> m_terminalNames;
+    std::vector<uint8_t> m_terminal; // Roles of each node
+    std::vector<Link> m_compacted;
+};
+
+} // namespace app
+
+#endif // LLNL_TOPOLOGY_PRUNER_HPP
@@ -0,0 +1,356 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_trace_parser.hpp
+//
+// Reader for the tab-separated .client.txt trace files that only looks at the
+// columns it is asked for. The file is read in large blocks; lines are found with
+// memchr and tabs with SSE2 compares of 16 bytes at a time, stopping at the last
+// wanted column. Fields are pointer and length views into the block, valid until
+// the next call to Next().
+//
+// Lines with too few columns are skipped and remembered with their line number,
+// as are lines the caller rejects with ReportError(), e.g. for a bad number; the
+// number parsers return false instead of throwing.
+
+#ifndef LLNL_TRACE_PARSER_HPP
+#define LLNL_TRACE_PARSER_HPP
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace app {
+
+struct TraceField
+{
+    const char* data;
+    size_t size;
+
+    std::string
+    str() const
+    {
+        return std::string(data, size);
+    }
+
+    bool
+    contains(const std::string& needle) const
+    {
+        return std::search(data, data + size, needle.begin(), needle.end()) != data + size || needle.empty();
+    }
+};
+
+class LlnlTraceParser
+{
+public:
+    enum : size_t {
+        BLOCK_SIZE = 4 << 20,
+        MAX_REPORTED = 20 // errors kept with their line number
+    };
+
+    // columns are 0-based, in the order Get() returns them
+    explicit
+    LlnlTraceParser(const std::vector<size_t>& columns)
+        : m_columns(columns)
+        , m_fields(columns.size())
+        , m_buffer(BLOCK_SIZE)
+    {
+        m_lastColumn = columns.empty() ? 0 : *std::max_element(columns.begin(), columns.end());
+        m_tabs.resize(m_lastColumn + 1);
+    }
+
+    ~LlnlTraceParser()
+    {
+        if (m_file != nullptr) {
+            std::fclose(m_file);
+        }
+    }
+
+    bool
+    Open(const std::string& fileName)
+    {
+        m_file = std::fopen(fileName.c_str(), "rb");
+        return m_file != nullptr;
+    }
+
+    // advance to the next line with all wanted columns; false at the end of the file
+    bool
+    Next()
+    {
+        while (NextLine()) {
+            if (m_line.size == 0) {
+                continue;
+            }
+            const char* end = m_line.data + m_line.size;
+            // the tab after the last wanted column ends it, if there is one
+            size_t nTabs = FindTabs(m_line.data, end, m_lastColumn + 1, m_tabs.data());
+            if (nTabs < m_lastColumn) {
+                ReportError("expected at least " + std::to_string(m_lastColumn + 1) + " columns, found " +
+                            std::to_string(nTabs + 1));
+                continue;
+            }
+            for (size_t i = 0; i < m_columns.size(); i++) {
+                size_t c = m_columns[i];
+                const char* begin = c == 0 ? m_line.data : m_tabs[c - 1] + 1;
+                const char* stop = c < nTabs ? m_tabs[c] : end;
+                m_fields[i] = TraceField{begin, static_cast<size_t>(stop - begin)};
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // i-th wanted column of the current line
+    const TraceField&
+    Get(size_t i) const
+    {
+        return m_fields[i];
+    }
+
+    const TraceField&
+    Line() const
+    {
+        return m_line;
+    }
+
+    uint64_t
+    GetLineNumber() const
+    {
+        return m_lineNumber;
+    }
+
+    void
+    ReportError(const std::string& reason)
+    {
+        if (m_errors.size() < MAX_REPORTED) {
+            m_errors.push_back(std::make_pair(m_lineNumber, reason));
+        }
+        m_nErrors++;
+    }
+
+    uint64_t
+    GetErrorCount() const
+    {
+        return m_nErrors;
+    }
+
+    void
+    PrintErrors(std::ostream& os, const std::string& fileName) const
+    {
+        for (const auto& error : m_errors) {
+            os << fileName << ":" << error.first << ": " << error.second << std::endl;
+        }
+        if (m_nErrors > m_errors.size()) {
+            os << fileName << ": " << m_nErrors - m_errors.size() << " more malformed lines" << std::endl;
+        }
+    }
+
+    static bool
+    ParseLong(const TraceField& field, long& value)
+    {
+        const char* p = field.data;
+        const char* end = p + field.size;
+        bool negative = p < end && *p == '-';
+        if (p < end && (*p == '-' || *p == '+')) {
+            p++;
+        }
+        if (p == end) {
+            return false;
+        }
+        unsigned long result = 0;
+        for (; p < end; p++) {
+            unsigned digit = static_cast<unsigned char>(*p) - '0';
+            if (digit > 9 || result > (static_cast<unsigned long>(-1) - digit) / 10) {
+                return false;
+            }
+            result = result * 10 + digit;
+        }
+        if (result > static_cast<unsigned long>(std::numeric_limits<long>::max()) + (negative ? 1 : 0)) {
+            return false;
+        }
+        value = negative ? -static_cast<long>(result) : static_cast<long>(result);
+        return true;
+    }
+
+    // [+-]digits[.digits][(e|E)[+-]digits]
+    static bool
+    ParseDouble(const TraceField& field, double& value)
+    {
+        const char* p = field.data;
+        const char* end = p + field.size;
+        bool negative = p < end && *p == '-';
+        if (p < end && (*p == '-' || *p == '+')) {
+            p++;
+        }
+        uint64_t mantissa = 0;
+        int exponent = 0;
+        int digits = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+            if (mantissa < 100000000000000000ULL) {
+                mantissa = mantissa * 10 + (*p - '0');
+            }
+            else {
+                exponent++;
+            }
+        }
+        if (p < end && *p == '.') {
+            for (p++; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+                if (mantissa < 100000000000000000ULL) {
+                    mantissa = mantissa * 10 + (*p - '0');
+                    exponent--;
+                }
+            }
+        }
+        if (digits == 0) {
+            return false;
+        }
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            TraceField rest{p + 1, static_cast<size_t>(end - p - 1)};
+            long e = 0;
+            if (!ParseLong(rest, e) || e > 400 || e < -400) {
+                return false;
+            }
+            exponent += static_cast<int>(e);
+            p = end;
+        }
+        if (p != end) {
+            return false;
+        }
+        double result = static_cast<double>(mantissa);
+        if (exponent > 0) {
+            result *= Power10(exponent);
+        }
+        else if (exponent < 0) {
+            result /= Power10(-exponent);
+        }
+        value = negative ? -result : result;
+        return true;
+    }
+
+private:
+    static double
+    Power10(int n)
+    {
+        static const double small[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                       1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        double result = 1;
+        for (; n > 22; n -= 22) {
+            result *= 1e22;
+        }
+        return result * small[n];
+    }
+
+    // positions of the first maxTabs tabs in [p, end)
+    static size_t
+    FindTabs(const char* p, const char* end, size_t maxTabs, const char** tabs)
+    {
+        size_t n = 0;
+#ifdef __SSE2__
+        const __m128i tab = _mm_set1_epi8('\t');
+        for (; p + 16 <= end; p += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, tab));
+            while (mask != 0) {
+                tabs[n++] = p + __builtin_ctz(mask);
+                if (n == maxTabs) {
+                    return n;
+                }
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for (; p < end; p++) {
+            if (*p == '\t') {
+                tabs[n++] = p;
+                if (n == maxTabs) {
+                    return n;
+                }
+            }
+        }
+        return n;
+    }
+
+    // the next line of the file without its end-of-line, refilling the block as needed
+    bool
+    NextLine()
+    {
+        while (true) {
+            const char* begin = m_buffer.data() + m_pos;
+            const char* newline = static_cast<const char*>(std::memchr(begin, '\n', m_end - m_pos));
+            if (newline != nullptr || (m_eof && m_pos < m_end)) {
+                const char* stop = newline != nullptr ? newline : m_buffer.data() + m_end;
+                m_pos = newline != nullptr ? newline - m_buffer.data() + 1 : m_end;
+                if (stop > begin && stop[-1] == '\r') {
+                    stop--;
+                }
+                m_line = TraceField{begin, static_cast<size_t>(stop - begin)};
+                m_lineNumber++;
+                return true;
+            }
+            if (m_eof || m_file == nullptr) {
+                return false;
+            }
+
+            // keep the partial line, grow the block if it does not fit
+            size_t partial = m_end - m_pos;
+            std::memmove(m_buffer.data(), m_buffer.data() + m_pos, partial);
+            m_pos = 0;
+            m_end = partial;
+            if (m_end == m_buffer.size()) {
+                m_buffer.resize(2 * m_buffer.size());
+            }
+            size_t n = std::fread(m_buffer.data() + m_end, 1, m_buffer.size() - m_end, m_file);
+            m_end += n;
+            if (n == 0) {
+                m_eof = true;
+            }
+        }
+    }
+
+private:
+    std::vector<size_t> m_columns;
+    size_t m_lastColumn;
+    std::vector<TraceField> m_fields;
+    std::vector<const char*> m_tabs;
+    TraceField m_line{nullptr, 0};
+
+    std::FILE* m_file = nullptr;
+    std::vector<char> m_buffer;
+    size_t m_pos = 0;
+    size_t m_end = 0;
+    bool m_eof = false;
+    uint64_t m_lineNumber = 0;
+
+    std::vector<std::pair<uint64_t, std::string>> m_errors;
+    uint64_t m_nErrors = 0;
+};
+
+} // namespace app
+
+#endif // LLNL_TRACE_PARSER_HPP
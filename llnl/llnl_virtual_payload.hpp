@@ -0,0 +1,300 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_virtual_payload.hpp
+//
+// Virtual payload: Data packets keep their one-byte content, but on the wire they
+// are followed by the logical size of their segment in zero-filled virtual bytes.
+// ns-3 packets keep such bytes as a size only, so transmission time, queue bytes and
+// link counters see the real volume while no buffer is ever allocated.
+//
+// The logical size comes from a registry of dataset sizes filled by the consumers
+// from the trace: segment s of a dataset of n bytes carries
+// min(max(n - s * SEGMENT_SIZE, 0), SEGMENT_SIZE) bytes. Data of unknown datasets
+// is sent as is.
+//
+// LlnlVirtualPayloadTransport replaces NetDeviceTransport on point-to-point faces;
+// it is installed with StackHelper::AddFaceCreateCallback before the stack.
+
+#ifndef LLNL_VIRTUAL_PAYLOAD_HPP
+#define LLNL_VIRTUAL_PAYLOAD_HPP
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include "ns3/ndnSIM/helper/ndn-stack-helper.hpp"
+#include "ns3/ndnSIM/model/ndn-block-header.hpp"
+#include "ns3/ndnSIM/model/ndn-l3-protocol.hpp"
+#include "ns3/ndnSIM/model/ndn-net-device-transport.hpp"
+#include "ns3/ndnSIM/NFD/daemon/face/generic-link-service.hpp"
+
+#include <ndn-cxx/name.hpp>
+
+#include <boost/lexical_cast.hpp>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace ns3 {
+
+class LlnlPayloadSizes
+{
+public:
+  static const uint64_t SEGMENT_SIZE = 100000000; // 100MB, as in the consumers
+
+  static LlnlPayloadSizes&
+  Get()
+  {
+    static LlnlPayloadSizes instance;
+    return instance;
+  }
+
+  void
+  Enable()
+  {
+    m_enabled = true;
+  }
+
+  bool
+  IsEnabled() const
+  {
+    return m_enabled;
+  }
+
+  // dataset is the Interest name without the two segment components
+  void
+  Register(const ndn::Name& dataset, double dataSize)
+  {
+    if (!m_enabled || dataSize <= 0) {
+      return;
+    }
+    m_sizes[Key(dataset, dataset.size())] = static_cast<uint64_t>(dataSize);
+  }
+
+  // logical payload of a Data name (dataset, max segment, segment), 0 if unknown
+  uint64_t
+  GetSize(const ndn::Name& dataName) const
+  {
+    if (dataName.size() < 2 || m_sizes.empty()) {
+      return 0;
+    }
+    auto it = m_sizes.find(Key(dataName, dataName.size() - 2));
+    if (it == m_sizes.end()) {
+      return 0;
+    }
+    const ndn::name::Component& last = dataName.get(-1);
+    if (last.value_size() < 2 || last.value()[0] != 0x00) {
+      return 0;
+    }
+    return SegmentBytes(it->second, ReadNumber(last.value() + 1, last.value_size() - 1));
+  }
+
+  // logical payload of an encoded packet, bare Data or an LpPacket carrying one
+  uint64_t
+  GetSize(const uint8_t* wire, size_t size) const
+  {
+    if (m_sizes.empty()) {
+      return 0;
+    }
+    const uint8_t* end = wire + size;
+    uint64_t type, length;
+    if (!ReadTlv(wire, end, type, length)) {
+      return 0;
+    }
+    if (type == 100) { // LpPacket, find the Fragment
+      end = wire + length;
+      do {
+        if (!ReadTlv(wire, end, type, length)) {
+          return 0;
+        }
+        wire += type != 80 ? length : 0;
+      } while (type != 80);
+      if (!ReadTlv(wire, end, type, length)) {
+        return 0;
+      }
+    }
+    if (type != 6 || !ReadTlv(wire, end, type, length) || type != 7) {
+      return 0;
+    }
+
+    // walk the Name, remembering where the last two components start
+    const uint8_t* nameBegin = wire;
+    const uint8_t* nameEnd = wire + length;
+    const uint8_t* secondLast = nullptr;
+    const uint8_t* last = nullptr;
+    while (wire < nameEnd) {
+      const uint8_t* component = wire;
+      if (!ReadTlv(wire, nameEnd, type, length)) {
+        return 0;
+      }
+      secondLast = last;
+      last = component;
+      wire += length;
+    }
+    if (secondLast == nullptr || length < 2 || *(wire - length) != 0x00) {
+      return 0;
+    }
+
+    auto it = m_sizes.find(std::string(reinterpret_cast<const char*>(nameBegin), secondLast - nameBegin));
+    if (it == m_sizes.end()) {
+      return 0;
+    }
+    return SegmentBytes(it->second, ReadNumber(wire - length + 1, length - 1));
+  }
+
+private:
+  static std::string
+  Key(const ndn::Name& name, size_t nComponents)
+  {
+    std::string key;
+    for (size_t i = 0; i < nComponents; i++) {
+      const ndn::Block& component = name.get(i);
+      key.append(reinterpret_cast<const char*>(component.wire()), component.size());
+    }
+    return key;
+  }
+
+  static uint64_t
+  SegmentBytes(uint64_t dataSize, uint64_t segment)
+  {
+    if (segment >= dataSize / SEGMENT_SIZE + 1) {
+      return 0;
+    }
+    uint64_t left = dataSize - segment * SEGMENT_SIZE;
+    return left < SEGMENT_SIZE ? left : SEGMENT_SIZE;
+  }
+
+  static uint64_t
+  ReadNumber(const uint8_t* bytes, size_t length)
+  {
+    uint64_t value = 0;
+    for (size_t i = 0; i < length && i < 8; i++) {
+      value = (value << 8) | bytes[i];
+    }
+    return value;
+  }
+
+  static bool
+  ReadVarNumber(const uint8_t*& wire, const uint8_t* end, uint64_t& value)
+  {
+    if (wire >= end) {
+      return false;
+    }
+    uint8_t first = *wire++;
+    size_t length = first < 253 ? 0 : first == 253 ? 2 : first == 254 ? 4 : 8;
+    if (static_cast<size_t>(end - wire) < length) {
+      return false;
+    }
+    value = length == 0 ? first : ReadNumber(wire, length);
+    wire += length;
+    return true;
+  }
+
+  // read a TLV header, leaving wire at the start of the value
+  static bool
+  ReadTlv(const uint8_t*& wire, const uint8_t* end, uint64_t& type, uint64_t& length)
+  {
+    return ReadVarNumber(wire, end, type) && ReadVarNumber(wire, end, length) &&
+           length <= static_cast<uint64_t>(end - wire);
+  }
+
+private:
+  bool m_enabled = false;
+  std::unordered_map<std::string, uint64_t> m_sizes;
+};
+
+class LlnlVirtualPayloadTransport : public ndn::NetDeviceTransport
+{
+public:
+  LlnlVirtualPayloadTransport(Ptr<Node> node, const Ptr<NetDevice>& netDevice,
+                              const std::string& localUri, const std::string& remoteUri)
+    : NetDeviceTransport(node, netDevice, localUri, remoteUri)
+  {
+  }
+
+  // face creation callback for point-to-point devices, as the stack helper's
+  // default one but with this transport
+  static std::shared_ptr<ndn::Face>
+  CreateFace(Ptr<Node> node, Ptr<ndn::L3Protocol> ndn, Ptr<NetDevice> device)
+  {
+    Ptr<PointToPointNetDevice> netDevice = DynamicCast<PointToPointNetDevice>(device);
+    NS_ASSERT(netDevice != nullptr);
+
+    Ptr<PointToPointChannel> channel = DynamicCast<PointToPointChannel>(netDevice->GetChannel());
+    NS_ASSERT(channel != nullptr);
+    Ptr<NetDevice> remoteNetDevice = channel->GetDevice(0);
+    if (remoteNetDevice->GetNode() == node) {
+      remoteNetDevice = channel->GetDevice(1);
+    }
+
+    ::nfd::face::GenericLinkService::Options opts;
+    opts.allowFragmentation = true;
+    opts.allowReassembly = true;
+
+    std::unique_ptr<::nfd::face::GenericLinkService> linkService(new ::nfd::face::GenericLinkService(opts));
+    std::unique_ptr<LlnlVirtualPayloadTransport> transport(
+      new LlnlVirtualPayloadTransport(node, netDevice, FaceUri(netDevice), FaceUri(remoteNetDevice)));
+
+    auto face = std::make_shared<ndn::Face>(std::move(linkService), std::move(transport));
+    face->setMetric(1);
+    ndn->addFace(face);
+    return face;
+  }
+
+  static void
+  Install(ndn::StackHelper& helper)
+  {
+    LlnlPayloadSizes::Get().Enable();
+    helper.AddFaceCreateCallback(PointToPointNetDevice::GetTypeId(),
+                                 MakeCallback(&LlnlVirtualPayloadTransport::CreateFace));
+  }
+
+private:
+  virtual void
+  doSend(Packet&& packet) override
+  {
+    ndn::BlockHeader header(packet);
+
+    // the receiving transport only reads the block header, the virtual bytes
+    // behind it are dropped with the packet
+    uint64_t virtualBytes = LlnlPayloadSizes::Get().GetSize(packet.packet.wire(), packet.packet.size());
+    Ptr<ns3::Packet> ns3Packet = Create<ns3::Packet>(static_cast<uint32_t>(virtualBytes));
+    ns3Packet->AddHeader(header);
+
+    Ptr<NetDevice> netDevice = GetNetDevice();
+    netDevice->Send(ns3Packet, netDevice->GetBroadcast(), ndn::L3Protocol::ETHERNET_FRAME_TYPE);
+  }
+
+  static std::string
+  FaceUri(Ptr<NetDevice> netDevice)
+  {
+    std::string uri = "netdev://";
+    Address address = netDevice->GetAddress();
+    if (Mac48Address::IsMatchingType(address)) {
+      uri += "[" + boost::lexical_cast<std::string>(Mac48Address::ConvertFrom(address)) + "]";
+    }
+    return uri;
+  }
+};
+
+} // namespace ns3
+
+#endif // LLNL_VIRTUAL_PAYLOAD_HPP
@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_workload_scaling.hpp
+//
+// Scaled-down replays of a trace week for exploration runs:
+//
+//  - time compression: trace offsets (parts[9] - timestamp) are divided by the
+//    factor, so a week at factor 7 replays in a day of simulated time
+//  - client sampling: a client is kept if a seeded hash of its IP falls below the
+//    fraction, so the same seed always picks the same clients
+//  - request thinning: of the requests a client makes for one dataset, every
+//    (1/fraction)-th is kept, starting at a hashed phase. Per-dataset counts are
+//    scaled by the same factor to within one request, which keeps the popularity
+//    ranking of the datasets.
+//
+// All three default to no scaling.
+
+#ifndef LLNL_WORKLOAD_SCALING_HPP
+#define LLNL_WORKLOAD_SCALING_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+namespace app {
+
+class LlnlWorkloadScaling
+{
+public:
+    static LlnlWorkloadScaling&
+    Get()
+    {
+        static LlnlWorkloadScaling instance;
+        return instance;
+    }
+
+    void
+    Configure(double timeCompression, double clientFraction, double thinning, uint64_t seed)
+    {
+        m_timeCompression = timeCompression > 0 ? timeCompression : 1;
+        m_clientFraction = clientFraction;
+        m_thinning = thinning;
+        m_seed = seed;
+    }
+
+    bool
+    IsScaled() const
+    {
+        return m_timeCompression != 1 || m_clientFraction < 1 || m_thinning < 1;
+    }
+
+    // trace offset in seconds to simulated seconds
+    double
+    ScaleTime(long offset) const
+    {
+        return m_timeCompression == 1 ? offset : offset / m_timeCompression;
+    }
+
+    double
+    GetTimeCompression() const
+    {
+        return m_timeCompression;
+    }
+
+    bool
+    SampleClient(const std::string& ip)
+    {
+        clientsTotal++;
+        if (m_clientFraction >= 1 || ToUnit(Hash(ip, m_seed)) < m_clientFraction) {
+            clientsKept++;
+            return true;
+        }
+        return false;
+    }
+
+    // per-client thinning state, one per trace file being read
+    class Thinner
+    {
+    public:
+        Thinner(LlnlWorkloadScaling& scaling, const std::string& ip)
+            : m_scaling(scaling)
+            , m_ip(ip)
+        {
+        }
+
+        bool
+        keep(const std::string& dataset)
+        {
+            double fraction = m_scaling.m_thinning;
+            if (fraction >= 1) {
+                m_scaling.recordsKept++;
+                return true;
+            }
+            auto it = m_seen.find(dataset);
+            if (it == m_seen.end()) {
+                double phase = ToUnit(Hash(m_ip + "\t" + dataset, m_scaling.m_seed));
+                it = m_seen.emplace(dataset, std::make_pair(phase, uint64_t(0))).first;
+            }
+            // keep request n when floor(phase + (n + 1) * f) steps past floor(phase + n * f)
+            double phase = it->second.first;
+            uint64_t n = it->second.second++;
+            bool kept = std::floor(phase + (n + 1) * fraction) > std::floor(phase + n * fraction);
+            (kept ? m_scaling.recordsKept : m_scaling.recordsThinned)++;
+            return kept;
+        }
+
+    private:
+        LlnlWorkloadScaling& m_scaling;
+        std::string m_ip;
+        std::unordered_map<std::string, std::pair<double, uint64_t>> m_seen;
+    };
+
+    Thinner
+    MakeThinner(const std::string& ip)
+    {
+        return Thinner(*this, ip);
+    }
+
+    void
+    PrintSettings(std::ostream& os) const
+    {
+        os << "Workload scaling: time compression " << m_timeCompression << ", client fraction "
+           << m_clientFraction << ", request thinning " << m_thinning << ", seed " << m_seed << std::endl;
+    }
+
+    void
+    PrintReport(std::ostream& os) const
+    {
+        PrintSettings(os);
+        os << "Workload scaling: kept " << clientsKept << " of " << clientsTotal << " clients, "
+           << recordsKept << " of " << recordsKept + recordsThinned << " requests" << std::endl;
+    }
+
+public:
+    uint64_t clientsTotal = 0;
+    uint64_t clientsKept = 0;
+    uint64_t recordsKept = 0;
+    uint64_t recordsThinned = 0;
+
+private:
+    // FNV-1a, mixed with the seed
+    static uint64_t
+    Hash(const std::string& value, uint64_t seed)
+    {
+        uint64_t hash = 14695981039346656037ULL ^ (seed * 0x9E3779B97F4A7C15ULL);
+        for (unsigned char c : value) {
+            hash = (hash ^ c) * 1099511628211ULL;
+        }
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    static double
+    ToUnit(uint64_t hash)
+    {
+        return (hash >> 11) * (1.0 / 9007199254740992.0); // 53 bits to [0, 1)
+    }
+
+private:
+    double m_timeCompression = 1;
+    double m_clientFraction = 1;
+    double m_thinning = 1;
+    uint64_t m_seed = 0;
+};
+
+} // namespace app
+
+#endif // LLNL_WORKLOAD_SCALING_HPP
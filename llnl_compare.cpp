@@ -0,0 +1,339 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_compare.cpp
+//
+// Runs one ndn-closer-site command line under several forwarding strategies, cache
+// sizes and seeds, so every strategy sees the same topology, clients, servers and
+// trace window, and reports the runs side by side. Example:
+//
+//   llnl_compare --sim="./build/ndn-closer-site --topology=t --servers=s --clients=c
+//                       --dict=d --windowStart=3600 --windowEnd=90000 --warmup=3600"
+//                --strategies=best-route,closer-site --caches=1000,10000 --seeds=1,2,3
+//                --jobs=8 --out=compare
+//
+// Each run writes <out>/<strategy>-c<cache>-s<seed>.{log,metrics,completion,links,
+// profile}. The report, printed and written to <out>/report.tsv, has one row per
+// strategy and cache size with the mean over the seeds of: requests, Data, timeouts
+// and Nacks, hop count mean, p50 and p90, dataset completion time p50, p90 and p99
+// (the global row of the completion file), bytes sent over all links, wall time and
+// peak RSS.
+
+#include "llnl/llnl_run_metrics.hpp"
+#include "llnl/llnl_tools.hpp"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static std::vector<std::string>
+splitList(const std::string& list)
+{
+  std::vector<std::string> items;
+  std::istringstream is(list);
+  std::string item;
+  while (getline(is, item, ',')) {
+    if (!item.empty()) {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
+struct Run
+{
+  std::string strategy;
+  std::string cache;
+  std::string seed;
+
+  std::string
+  prefix(const std::string& out) const
+  {
+    return out + "/" + strategy + "-c" + cache + "-s" + seed;
+  }
+};
+
+// figures of one run, or the mean of several
+struct Result
+{
+  static const int N_FIELDS = 14;
+  double values[N_FIELDS] = {0};
+};
+
+static const char* FIELD_NAMES[Result::N_FIELDS] = {
+  "requests", "data", "timeouts", "nacks", "hops_mean", "hops_p50", "hops_p90",
+  "completion_p50", "completion_p90", "completion_p99", "link_mb", "wall_sec", "peak_rss_mb", "runs"
+};
+
+// p50, p90 and p99 of the global completion row
+static bool
+readCompletion(const std::string& fileName, double quantiles[3])
+{
+  std::ifstream is(fileName);
+  std::string line;
+  while (getline(is, line)) {
+    std::istringstream ss(line);
+    std::vector<std::string> columns;
+    std::string column;
+    while (getline(ss, column, '\t')) {
+      columns.push_back(column);
+    }
+    // scope key completed abandoned unfinished mean min p50 p90 p99 max
+    if (columns.size() >= 11 && columns[0] == "global") {
+      for (int i = 0; i < 3; i++) {
+        quantiles[i] = std::atof(columns[7 + i].c_str());
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+// total bytes of all link directions in an LLNLLINK file
+static bool
+readLinkBytes(const std::string& fileName, double& bytes)
+{
+  std::ifstream is(fileName, std::ios::binary);
+  char magic[8];
+  uint32_t version, nBuckets, nDirections;
+  uint64_t bucketWidth;
+  is.read(magic, 8);
+  is.read(reinterpret_cast<char*>(&version), sizeof(version));
+  is.read(reinterpret_cast<char*>(&bucketWidth), sizeof(bucketWidth));
+  is.read(reinterpret_cast<char*>(&nBuckets), sizeof(nBuckets));
+  is.read(reinterpret_cast<char*>(&nDirections), sizeof(nDirections));
+  if (!is || std::memcmp(magic, "LLNLLINK", 8) != 0 || version != 1) {
+    return false;
+  }
+  bytes = 0;
+  for (uint32_t d = 0; d < nDirections && is; d++) {
+    for (int name = 0; name < 2; name++) {
+      uint16_t length;
+      is.read(reinterpret_cast<char*>(&length), sizeof(length));
+      is.ignore(length);
+    }
+    for (uint32_t b = 0; b < nBuckets; b++) {
+      uint64_t counters[3]; // bytes, packets, drops
+      is.read(reinterpret_cast<char*>(counters), sizeof(counters));
+      is.ignore(sizeof(uint32_t) + sizeof(float));
+      bytes += counters[0];
+    }
+  }
+  return static_cast<bool>(is);
+}
+
+// a number field of the profile JSON
+static double
+readProfileField(const std::string& fileName, const std::string& key)
+{
+  std::ifstream is(fileName);
+  std::string json((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+  size_t pos = json.find("\"" + key + "\": ");
+  return pos != std::string::npos ? std::atof(json.c_str() + pos + key.size() + 4) : 0;
+}
+
+static bool
+readResult(const std::string& prefix, Result& result)
+{
+  app::LlnlRunMetrics metrics;
+  if (!metrics.Read(prefix + ".metrics")) {
+    std::cout << "Missing metrics " << prefix << ".metrics" << std::endl;
+    return false;
+  }
+  double* v = result.values;
+  v[0] = metrics.requests;
+  v[1] = metrics.data;
+  v[2] = metrics.timeouts;
+  v[3] = metrics.nacks;
+  uint64_t hopSamples = app::hopTotal(metrics);
+  v[4] = hopSamples > 0 ? static_cast<double>(metrics.hopCountSum) / hopSamples : 0;
+  v[5] = app::hopQuantile(metrics, 0.5);
+  v[6] = app::hopQuantile(metrics, 0.9);
+  if (!readCompletion(prefix + ".completion", v + 7)) {
+    std::cout << "No completion times in " << prefix << ".completion" << std::endl;
+  }
+  double bytes = 0;
+  if (!readLinkBytes(prefix + ".links", bytes)) {
+    std::cout << "Unreadable link stats " << prefix << ".links" << std::endl;
+  }
+  v[10] = bytes / 1e6;
+  v[11] = readProfileField(prefix + ".profile", "total_wall_sec");
+  v[12] = readProfileField(prefix + ".profile", "peak_rss_kb") / 1024;
+  v[13] = 1;
+  return true;
+}
+
+int
+main(int argc, char* argv[])
+{
+  std::string sim;
+  std::string out = "compare";
+  std::string value;
+  std::vector<std::string> strategies = {"best-route", "closer-site"};
+  std::vector<std::string> caches = {"1000"};
+  std::vector<std::string> seeds = {"1"};
+  int jobs = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (app::parseOption(argv[i], "sim", value)) sim = value;
+    else if (app::parseOption(argv[i], "out", value)) out = value;
+    else if (app::parseOption(argv[i], "strategies", value)) strategies = splitList(value);
+    else if (app::parseOption(argv[i], "caches", value)) caches = splitList(value);
+    else if (app::parseOption(argv[i], "seeds", value)) seeds = splitList(value);
+    else if (app::parseOption(argv[i], "jobs", value)) jobs = std::atoi(value.c_str());
+    else {
+      std::cout << "Unknown option " << argv[i] << std::endl;
+      return 1;
+    }
+  }
+  if (sim.empty() || strategies.empty() || caches.empty() || seeds.empty()) {
+    std::cout << "Usage: llnl_compare --sim=\"<ndn-closer-site command>\" [--strategies=a,b]"
+              << " [--caches=n,...] [--seeds=n,...] [--jobs=N] [--out=dir]" << std::endl;
+    return 1;
+  }
+  if (jobs <= 0) {
+    jobs = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+  }
+  mkdir(out.c_str(), 0755);
+
+  std::vector<Run> runs;
+  for (const auto& cache : caches) {
+    for (const auto& strategy : strategies) {
+      for (const auto& seed : seeds) {
+        runs.push_back(Run{strategy, cache, seed});
+      }
+    }
+  }
+
+  std::map<pid_t, size_t> running;
+  size_t next = 0;
+  int failed = 0;
+  while (next < runs.size() || !running.empty()) {
+    while (next < runs.size() && static_cast<int>(running.size()) < jobs) {
+      const Run& run = runs[next];
+      std::string prefix = run.prefix(out);
+      std::string command = sim
+        + " --strategy=" + run.strategy
+        + " --ncache=" + run.cache
+        + " --RngRun=" + run.seed
+        + " --scalingSeed=" + run.seed
+        + " --metrics=" + prefix + ".metrics"
+        + " --completion=" + prefix + ".completion"
+        + " --linkStats=" + prefix + ".links"
+        + " --profile=" + prefix + ".profile"
+        + " > " + prefix + ".log 2>&1";
+
+      pid_t pid = fork();
+      if (pid == 0) {
+        execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+      }
+      if (pid < 0) {
+        std::cout << "fork failed for " << prefix << std::endl;
+        return 1;
+      }
+      std::cout << "Run " << prefix << " pid " << pid << std::endl;
+      running[pid] = next++;
+    }
+
+    int status = 0;
+    pid_t pid = waitpid(-1, &status, 0);
+    if (pid < 0) {
+      break;
+    }
+    auto it = running.find(pid);
+    if (it == running.end()) {
+      continue;
+    }
+    std::string prefix = runs[it->second].prefix(out);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      std::cout << "Run " << prefix << " failed with status " << status << std::endl;
+      failed++;
+    }
+    else {
+      std::cout << "Run " << prefix << " done" << std::endl;
+    }
+    running.erase(it);
+  }
+
+  // mean over the seeds per (cache, strategy)
+  std::map<std::pair<std::string, std::string>, Result> means;
+  for (const Run& run : runs) {
+    Result result;
+    if (!readResult(run.prefix(out), result)) {
+      failed++;
+      continue;
+    }
+    Result& mean = means[std::make_pair(run.cache, run.strategy)];
+    for (int i = 0; i < Result::N_FIELDS; i++) {
+      mean.values[i] += result.values[i];
+    }
+  }
+  for (auto& mean : means) {
+    double n = mean.second.values[Result::N_FIELDS - 1];
+    for (int i = 0; i < Result::N_FIELDS - 1 && n > 0; i++) {
+      mean.second.values[i] /= n;
+    }
+  }
+
+  std::ofstream tsv(out + "/report.tsv");
+  tsv << "cache\tstrategy";
+  for (const char* name : FIELD_NAMES) {
+    tsv << "\t" << name;
+  }
+  tsv << "\n";
+  for (const auto& mean : means) {
+    tsv << mean.first.first << "\t" << mean.first.second;
+    for (double v : mean.second.values) {
+      tsv << "\t" << v;
+    }
+    tsv << "\n";
+  }
+
+  // one block per cache size, one column per strategy
+  for (const auto& cache : caches) {
+    std::cout << std::endl << "Cache " << cache << std::endl << std::setw(16) << "";
+    for (const auto& strategy : strategies) {
+      std::cout << std::setw(16) << strategy;
+    }
+    std::cout << std::endl;
+    for (int i = 0; i < Result::N_FIELDS; i++) {
+      std::cout << std::setw(16) << FIELD_NAMES[i];
+      for (const auto& strategy : strategies) {
+        auto mean = means.find(std::make_pair(cache, strategy));
+        std::cout << std::setw(16) << std::setprecision(6)
+                  << (mean != means.end() ? mean->second.values[i] : 0);
+      }
+      std::cout << std::endl;
+    }
+  }
+
+  return failed == 0 ? 0 : 1;
+}
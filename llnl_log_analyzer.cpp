@@ -0,0 +1,580 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_log_analyzer.cpp
+//
+// Statistics of archived runs from the lines the consumer prints to stdout
+// ("Time: ...,node:...,func:Consumer:delayedInterest|onData|onTimeout|onNack,...").
+// Example:
+//
+//   llnl_log_analyzer --threads=16 --out=runs.tsv runs/*.log
+//
+// Each log is memory-mapped and read in batches of chunks, one per thread. A thread
+// parses its chunk into per-shard lists of line views, sharded by the consumer node;
+// then every thread replays its shard's lists in file order. A request is the
+// Interests of one trace record, which share the nonce of its first Interest; a
+// retransmission after a timeout gets a new nonce and is tied back to its request by
+// the node and the Interest name. A request is complete when the Data of all its
+// segments has arrived, and is then dropped, so memory follows the requests in
+// flight rather than the log size.
+//
+// One TSV row per log, printed and optionally written to --out, with the counts of
+// requests, Interests, retransmissions, Data, timeouts and Nacks, the hop count mean
+// and quantiles, the completed and unfinished requests, the completion time mean and
+// quantiles, and the Nacks per reason. --metrics=<dir> also writes each log's counts
+// as <dir>/<log name>.metrics, for llnl_shard_runner style merging.
+
+#include "llnl/llnl_completion.hpp"
+#include "llnl/llnl_run_metrics.hpp"
+#include "llnl/llnl_tools.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+enum LineType : uint8_t {
+  INTEREST,
+  DATA,
+  TIMEOUT,
+  NACK
+};
+
+// a consumer line, as views into the mapped log
+struct Line
+{
+  double time;
+  const char* node;
+  const char* name;
+  const char* reason;
+  uint32_t nodeLength;
+  uint32_t nameLength;
+  uint32_t reasonLength;
+  uint32_t nonce;
+  uint32_t hops;
+  LineType type;
+};
+
+static const char*
+find(const char* begin, const char* end, const char* needle)
+{
+  size_t length = std::strlen(needle);
+  const char* found = std::search(begin, end, needle, needle + length);
+  return found != end ? found + length : nullptr;
+}
+
+static const char*
+findChar(const char* begin, const char* end, char c)
+{
+  const char* found = static_cast<const char*>(std::memchr(begin, c, end - begin));
+  return found != nullptr ? found : end;
+}
+
+static uint32_t
+parseNumber(const char* p, const char* end)
+{
+  uint64_t value = 0;
+  for (; p < end && *p >= '0' && *p <= '9'; p++) {
+    value = value * 10 + (*p - '0');
+  }
+  return static_cast<uint32_t>(value);
+}
+
+// Time: <t>,node:<id>,func:Consumer:<type>,IP:<ip> ,Interest Nonce <n> ,Data Name <name>,Hop Count <h>
+// Time: <t>,node:<id>,func:Consumer:<type>,IP:<ip>,Interest Name <name>[ Nonce <n>| Reason <r>]
+static bool
+parseLine(const char* begin, const char* end, Line& line)
+{
+  if (end - begin < 6 || std::memcmp(begin, "Time: ", 6) != 0) {
+    return false;
+  }
+  const char* func = find(begin, end, ",func:Consumer:");
+  const char* node = find(begin, end, ",node:");
+  if (func == nullptr || node == nullptr) {
+    return false;
+  }
+  // ns-3 prints the time as +<seconds>s
+  line.time = std::strtod(begin + 6, nullptr);
+  line.node = node;
+  line.nodeLength = findChar(node, end, ',') - node;
+  line.reason = nullptr;
+  line.reasonLength = 0;
+  line.nonce = 0;
+  line.hops = 0;
+
+  const char* name;
+  if (std::strncmp(func, "onData", 6) == 0) {
+    line.type = DATA;
+    const char* nonce = find(func, end, "Interest Nonce ");
+    name = nonce != nullptr ? find(nonce, end, "Data Name ") : nullptr;
+    const char* hops = name != nullptr ? find(name, end, ",Hop Count ") : nullptr;
+    if (hops == nullptr) {
+      return false;
+    }
+    line.nonce = parseNumber(nonce, end);
+    line.hops = parseNumber(hops, end);
+    line.name = name;
+    line.nameLength = hops - std::strlen(",Hop Count ") - name;
+    return true;
+  }
+
+  name = find(func, end, ",Interest Name ");
+  if (name == nullptr) {
+    return false;
+  }
+  line.name = name;
+  line.nameLength = findChar(name, end, ' ') - name;
+  const char* rest = name + line.nameLength;
+  if (std::strncmp(func, "delayedInterest", 15) == 0) {
+    line.type = INTEREST;
+    const char* nonce = find(rest, end, " Nonce ");
+    if (nonce == nullptr) {
+      return false;
+    }
+    line.nonce = parseNumber(nonce, end);
+  }
+  else if (std::strncmp(func, "onTimeout", 9) == 0) {
+    line.type = TIMEOUT;
+  }
+  else if (std::strncmp(func, "onNack", 6) == 0) {
+    line.type = NACK;
+    const char* reason = find(rest, end, " Reason ");
+    if (reason != nullptr) {
+      line.reason = reason;
+      line.reasonLength = end - reason;
+    }
+  }
+  else {
+    return false;
+  }
+  return true;
+}
+
+// value of a %-escaped name component that starts with marker, e.g. 0x00 for segments
+static bool
+decodeComponent(const char* p, const char* end, uint8_t marker, uint64_t& value)
+{
+  std::vector<uint8_t> bytes;
+  while (p < end) {
+    if (*p == '%' && end - p >= 3) {
+      bytes.push_back(static_cast<uint8_t>(std::strtoul(std::string(p + 1, 2).c_str(), nullptr, 16)));
+      p += 3;
+    }
+    else {
+      bytes.push_back(static_cast<uint8_t>(*p++));
+    }
+  }
+  if (bytes.empty() || bytes[0] != marker || bytes.size() > 9) {
+    return false;
+  }
+  value = 0;
+  for (size_t i = 1; i < bytes.size(); i++) {
+    value = (value << 8) | bytes[i];
+  }
+  return true;
+}
+
+// segment and last segment from /cmip5/app/<dataset>/<max segment>/<segment>[/<version>];
+// the Interest name is the Data name without its version
+static bool
+parseSegments(const char* name, uint32_t& length, uint64_t& segment, uint64_t& maxSegment)
+{
+  const char* end = name + length;
+  const char* slash = end;
+  while (slash > name && *(slash - 1) != '/') {
+    slash--;
+  }
+  if (end - slash >= 3 && std::memcmp(slash, "%FD", 3) == 0 && slash > name) {
+    end = slash - 1;
+    length = end - name;
+  }
+  const char* components[3] = {end, nullptr, nullptr};
+  for (int i = 1; i < 3; i++) {
+    const char* p = components[i - 1] - (i > 1 ? 1 : 0);
+    while (p > name && *(p - 1) != '/') {
+      p--;
+    }
+    if (p == name) {
+      return false;
+    }
+    components[i] = p;
+  }
+  return decodeComponent(components[1], end, 0x00, segment) &&
+         decodeComponent(components[2], components[1] - 1, 0x00, maxSegment);
+}
+
+struct Request
+{
+  double start;
+  double last;
+  app::DownloadProgress segments; // 0..maxSegment-1, as the consumers ask for them
+  std::vector<uint64_t> nonces; // keys of the nonces its Interests carried
+  bool nacked;
+};
+
+// the requests of the nodes of one shard, replayed in file order
+class Shard
+{
+public:
+  void
+  Add(const Line& line)
+  {
+    std::string node(line.node, line.nodeLength);
+    auto n = m_nodes.insert(std::make_pair(node, m_nodes.size())).first->second;
+    uint64_t key = (static_cast<uint64_t>(n) << 32) | line.nonce;
+    std::string nameKey = std::to_string(n) + '\t' + std::string(line.name, line.nameLength);
+
+    switch (line.type) {
+    case INTEREST: {
+      metrics.interests++;
+      auto alias = m_aliases.find(key);
+      if (alias == m_aliases.end()) {
+        auto retry = m_retrying.find(nameKey);
+        if (retry != m_retrying.end()) {
+          // the retransmission of a timed-out Interest, with a new nonce
+          retransmissions++;
+          alias = m_aliases.insert(std::make_pair(key, retry->second)).first;
+          auto request = m_requests.find(retry->second);
+          if (request != m_requests.end()) {
+            request->second.nonces.push_back(key);
+          }
+          m_retrying.erase(retry);
+        }
+        else {
+          metrics.requests++;
+          alias = m_aliases.insert(std::make_pair(key, key)).first;
+          Request& request = m_requests[key];
+          request.start = line.time;
+          request.last = line.time;
+          request.nonces.push_back(key);
+          request.nacked = false;
+          uint32_t length = line.nameLength;
+          uint64_t segment, maxSegment;
+          if (parseSegments(line.name, length, segment, maxSegment)) {
+            request.segments = app::DownloadProgress(maxSegment);
+          }
+        }
+      }
+      m_outstanding[nameKey] = alias->second;
+      break;
+    }
+    case DATA: {
+      metrics.data++;
+      metrics.AddHopCount(line.hops);
+      uint32_t length = line.nameLength;
+      uint64_t segment = 0, maxSegment = 0;
+      bool hasSegment = parseSegments(line.name, length, segment, maxSegment);
+      m_outstanding.erase(std::to_string(n) + '\t' + std::string(line.name, length));
+      auto alias = m_aliases.find(key);
+      auto request = alias != m_aliases.end() ? m_requests.find(alias->second) : m_requests.end();
+      if (request == m_requests.end()) {
+        orphans++;
+        break;
+      }
+      Request& r = request->second;
+      r.last = line.time;
+      if (hasSegment && r.segments.Receive(segment)) {
+        completion.push_back(r.last - r.start);
+        for (uint64_t nonce : r.nonces) {
+          m_aliases.erase(nonce);
+        }
+        m_requests.erase(request);
+      }
+      break;
+    }
+    case TIMEOUT: {
+      metrics.timeouts++;
+      auto outstanding = m_outstanding.find(nameKey);
+      if (outstanding != m_outstanding.end()) {
+        m_retrying[nameKey] = outstanding->second;
+        m_outstanding.erase(outstanding);
+      }
+      break;
+    }
+    case NACK: {
+      metrics.nacks++;
+      nackReasons[std::string(line.reason != nullptr ? line.reason : "", line.reasonLength)]++;
+      auto outstanding = m_outstanding.find(nameKey);
+      if (outstanding != m_outstanding.end()) {
+        auto request = m_requests.find(outstanding->second);
+        if (request != m_requests.end()) {
+          request->second.nacked = true;
+        }
+        m_outstanding.erase(outstanding);
+      }
+      break;
+    }
+    }
+  }
+
+  // requests still open at the end of the log
+  void
+  Finish()
+  {
+    for (const auto& request : m_requests) {
+      (request.second.nacked ? abandoned : unfinished)++;
+    }
+  }
+
+public:
+  app::LlnlRunMetrics metrics;
+  uint64_t retransmissions = 0;
+  uint64_t orphans = 0; // Data of an unknown nonce, e.g. sent before the log starts
+  uint64_t unfinished = 0;
+  uint64_t abandoned = 0;
+  std::vector<float> completion;
+  std::map<std::string, uint64_t> nackReasons;
+
+private:
+  std::unordered_map<std::string, uint32_t> m_nodes;
+  std::unordered_map<uint64_t, Request> m_requests;
+  std::unordered_map<uint64_t, uint64_t> m_aliases;        // nonce key -> request key
+  std::unordered_map<std::string, uint64_t> m_outstanding; // node and name -> request key
+  std::unordered_map<std::string, uint64_t> m_retrying;    // timed out, not yet sent again
+};
+
+static size_t
+shardOf(const char* node, size_t length, size_t nShards)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < length; i++) {
+    hash = (hash ^ static_cast<uint8_t>(node[i])) * 1099511628211ULL;
+  }
+  return hash % nShards;
+}
+
+static double
+quantile(std::vector<float>& values, double q)
+{
+  if (values.empty()) {
+    return 0;
+  }
+  auto nth = values.begin() + static_cast<size_t>(q * (values.size() - 1));
+  std::nth_element(values.begin(), nth, values.end());
+  return *nth;
+}
+
+static const char* HEADER =
+  "log\tlines\trequests\tinterests\tretransmissions\tdata\ttimeouts\tnacks\torphan_data"
+  "\thops_mean\thops_p50\thops_p90\thops_p99\tcompleted\tabandoned\tunfinished"
+  "\tcompletion_mean\tcompletion_p50\tcompletion_p90\tcompletion_p99\tcompletion_max\tnack_reasons";
+
+static bool
+analyze(const std::string& fileName, size_t nThreads, size_t chunkSize, const std::string& metricsDir,
+        std::string& row)
+{
+  int fd = open(fileName.c_str(), O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    std::cout << "Cannot open " << fileName << std::endl;
+    if (fd >= 0) {
+      close(fd);
+    }
+    return false;
+  }
+  size_t size = st.st_size;
+  const char* data = nullptr;
+  if (size > 0) {
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+      std::cout << "Cannot map " << fileName << std::endl;
+      close(fd);
+      return false;
+    }
+    madvise(mapped, size, MADV_SEQUENTIAL);
+    data = static_cast<const char*>(mapped);
+  }
+  close(fd);
+
+  std::vector<Shard> shards(nThreads);
+  // lists[chunk][shard], reused from batch to batch
+  std::vector<std::vector<std::vector<Line>>> lists(nThreads, std::vector<std::vector<Line>>(nThreads));
+  std::vector<uint64_t> lineCounts(nThreads, 0);
+  const char* end = data + size;
+  const char* batch = data;
+  while (batch < end) {
+    // chunks start after a newline
+    std::vector<const char*> bounds(1, batch);
+    for (size_t c = 0; c < nThreads; c++) {
+      const char* next = std::min<const char*>(bounds.back() + chunkSize, end);
+      next = next < end ? findChar(next, end, '\n') : end;
+      bounds.push_back(next < end ? next + 1 : end);
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t c = 0; c < nThreads; c++) {
+      threads.push_back(std::thread([&, c] {
+        for (auto& list : lists[c]) {
+          list.clear();
+        }
+        Line line;
+        for (const char* p = bounds[c]; p < bounds[c + 1];) {
+          const char* eol = findChar(p, bounds[c + 1], '\n');
+          lineCounts[c]++;
+          if (parseLine(p, eol, line)) {
+            lists[c][shardOf(line.node, line.nodeLength, nThreads)].push_back(line);
+          }
+          p = eol + 1;
+        }
+      }));
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    threads.clear();
+
+    for (size_t s = 0; s < nThreads; s++) {
+      threads.push_back(std::thread([&, s] {
+        for (size_t c = 0; c < nThreads; c++) {
+          for (const Line& line : lists[c][s]) {
+            shards[s].Add(line);
+          }
+        }
+      }));
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    batch = bounds.back();
+  }
+  if (data != nullptr) {
+    munmap(const_cast<char*>(data), size);
+  }
+
+  Shard total;
+  uint64_t lines = 0;
+  for (size_t s = 0; s < nThreads; s++) {
+    shards[s].Finish();
+    lines += lineCounts[s];
+    total.metrics.Merge(shards[s].metrics);
+    total.retransmissions += shards[s].retransmissions;
+    total.orphans += shards[s].orphans;
+    total.unfinished += shards[s].unfinished;
+    total.abandoned += shards[s].abandoned;
+    total.completion.insert(total.completion.end(), shards[s].completion.begin(), shards[s].completion.end());
+    for (const auto& reason : shards[s].nackReasons) {
+      total.nackReasons[reason.first] += reason.second;
+    }
+    shards[s] = Shard();
+  }
+
+  const app::LlnlRunMetrics& m = total.metrics;
+  double completionMean = 0;
+  for (float t : total.completion) {
+    completionMean += t;
+  }
+  completionMean = total.completion.empty() ? 0 : completionMean / total.completion.size();
+  std::ostringstream os;
+  os << fileName << "\t" << lines << "\t" << m.requests << "\t" << m.interests << "\t" << total.retransmissions
+     << "\t" << m.data << "\t" << m.timeouts << "\t" << m.nacks << "\t" << total.orphans << "\t"
+     << (m.data > 0 ? static_cast<double>(m.hopCountSum) / m.data : 0) << "\t" << app::hopQuantile(m, 0.5)
+     << "\t" << app::hopQuantile(m, 0.9) << "\t" << app::hopQuantile(m, 0.99) << "\t" << total.completion.size()
+     << "\t" << total.abandoned << "\t" << total.unfinished << "\t" << completionMean << "\t"
+     << quantile(total.completion, 0.5) << "\t" << quantile(total.completion, 0.9) << "\t"
+     << quantile(total.completion, 0.99) << "\t" << quantile(total.completion, 1) << "\t";
+  for (auto reason = total.nackReasons.begin(); reason != total.nackReasons.end(); ++reason) {
+    os << (reason != total.nackReasons.begin() ? "," : "") << reason->first << ":" << reason->second;
+  }
+  if (total.nackReasons.empty()) {
+    os << "-";
+  }
+  row = os.str();
+
+  if (!metricsDir.empty()) {
+    size_t slash = fileName.find_last_of('/');
+    std::string base = slash == std::string::npos ? fileName : fileName.substr(slash + 1);
+    std::string metricsFile = metricsDir + "/" + base + ".metrics";
+    if (!m.Write(metricsFile)) {
+      std::cout << "Failed to write " << metricsFile << std::endl;
+    }
+  }
+  return true;
+}
+
+int
+main(int argc, char* argv[])
+{
+  std::string out;
+  std::string metricsDir;
+  std::string value;
+  size_t threads = std::thread::hardware_concurrency();
+  size_t chunkMb = 64;
+  std::vector<std::string> logs;
+
+  for (int i = 1; i < argc; i++) {
+    if (app::parseOption(argv[i], "out", value)) out = value;
+    else if (app::parseOption(argv[i], "metrics", value)) metricsDir = value;
+    else if (app::parseOption(argv[i], "threads", value)) threads = std::atoi(value.c_str());
+    else if (app::parseOption(argv[i], "chunkMb", value)) chunkMb = std::atoi(value.c_str());
+    else if (std::strncmp(argv[i], "--", 2) == 0) {
+      std::cout << "Unknown option " << argv[i] << std::endl;
+      return 1;
+    }
+    else {
+      logs.push_back(argv[i]);
+    }
+  }
+  if (logs.empty() || chunkMb == 0) {
+    std::cout << "Usage: llnl_log_analyzer [--threads=N] [--chunkMb=64] [--out=file.tsv]"
+              << " [--metrics=dir] <log>..." << std::endl;
+    return 1;
+  }
+  if (threads == 0) {
+    threads = 1;
+  }
+  if (!metricsDir.empty()) {
+    mkdir(metricsDir.c_str(), 0755);
+  }
+
+  std::ofstream os;
+  if (!out.empty()) {
+    os.open(out);
+    if (!os) {
+      std::cout << "Cannot write " << out << std::endl;
+      return 1;
+    }
+    os << HEADER << "\n";
+  }
+  std::cout << HEADER << std::endl;
+  int failed = 0;
+  for (const std::string& log : logs) {
+    std::string row;
+    if (!analyze(log, threads, chunkMb << 20, metricsDir, row)) {
+      failed++;
+      continue;
+    }
+    std::cout << row << std::endl;
+    if (os.is_open()) {
+      os << row << "\n";
+    }
+  }
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_replica_placement.cpp
+//
+// Places dataset replicas on the servers for a trace week, under per-server storage
+// limits, and writes the placement ndn-closer-site reads with --placement. Example:
+//
+//   llnl_replica_placement --topology=week.csv.topology --servers=week.csv.servers
+//                          --clients=week.csv.clients --dict=/raid/LLNL_ACCESS_LOG/run_week_1443689480/
+//                          --capacity=50e12 --out=placement.txt
+//
+// --capacities names a file of "<server> <bytes>" lines overriding --capacity.
+
+#include "llnl/llnl_replica_placement.hpp"
+#include "llnl/llnl_tools.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+
+int
+main(int argc, char* argv[])
+{
+  std::string topology;
+  std::string servers;
+  std::string clients;
+  std::string dict;
+  std::string capacities;
+  std::string out = "placement.txt";
+  std::string value;
+  double capacity = 1e15;
+
+  for (int i = 1; i < argc; i++) {
+    if (app::parseOption(argv[i], "topology", value)) topology = value;
+    else if (app::parseOption(argv[i], "servers", value)) servers = value;
+    else if (app::parseOption(argv[i], "clients", value)) clients = value;
+    else if (app::parseOption(argv[i], "dict", value)) dict = value;
+    else if (app::parseOption(argv[i], "capacity", value)) capacity = std::atof(value.c_str());
+    else if (app::parseOption(argv[i], "capacities", value)) capacities = value;
+    else if (app::parseOption(argv[i], "out", value)) out = value;
+    else {
+      std::cout << "Unknown option " << argv[i] << std::endl;
+      return 1;
+    }
+  }
+  if (topology.empty() || servers.empty() || clients.empty()) {
+    std::cout << "Usage: llnl_replica_placement --topology=<file> --servers=<file> --clients=<file>"
+              << " [--dict=<trace dir>/] [--capacity=bytes] [--capacities=<file>] [--out=file]" << std::endl;
+    return 1;
+  }
+
+  app::LlnlReplicaPlacement placement;
+  if (!placement.ReadTopology(topology)) {
+    std::cout << "Cannot read " << topology << std::endl;
+    return 1;
+  }
+
+  std::map<std::string, double> perServer;
+  std::ifstream capacityFile(capacities);
+  std::string name;
+  double bytes;
+  while (capacityFile >> name >> bytes) {
+    perServer[name] = bytes;
+  }
+
+  std::ifstream serverFile(servers);
+  std::string line;
+  while (getline(serverFile, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    auto it = perServer.find(line);
+    placement.AddServer(line, it != perServer.end() ? it->second : capacity);
+  }
+
+  std::ifstream clientFile(clients);
+  int missing = 0;
+  while (getline(clientFile, line)) {
+    if (!line.empty() && !placement.ReadClientTrace(line, dict + line + ".client.txt")) {
+      missing++;
+    }
+  }
+  if (missing > 0) {
+    std::cout << missing << " client traces could not be read" << std::endl;
+  }
+
+  placement.Optimise();
+  placement.PrintSummary(std::cout);
+  if (!placement.Write(out)) {
+    std::cout << "Cannot write " << out << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_scheduler_bench.cpp
+//
+// Replays scheduler operations through several ns-3 schedulers and reports the
+// cost per operation. The operations come from a scenario run with
+// --eventTrace=<file>, or from a synthetic hold model shaped like our runs: trace
+// Interests at whole-second timestamps over the week, many at the same second, and
+// packet events a few ms ahead. Example:
+//
+//   llnl_scheduler_bench --trace=events.bin
+//   llnl_scheduler_bench --synthetic=5000000 --schedulers=ns3::HeapScheduler,LlnlLadderScheduler
+
+#include "llnl/llnl_event_trace.hpp"
+#include "llnl/llnl_ladder_scheduler.hpp"
+
+#include "ns3/core-module.h"
+
+#include <boost/algorithm/string.hpp>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED(LlnlLadderScheduler);
+
+static std::vector<app::LlnlEventRecord>
+MakeSynthetic(uint64_t operations, uint64_t pending, uint32_t seed)
+{
+  const uint64_t SECOND = 1000000000;
+  const uint64_t WEEK = 605800;
+  std::mt19937_64 rng(seed);
+  std::exponential_distribution<double> packetDelay(1.0 / 5e6); // mean 5 ms
+  std::uniform_int_distribution<uint64_t> traceSecond(0, WEEK);
+  std::uniform_int_distribution<int> kind(0, 9);
+
+  std::vector<app::LlnlEventRecord> records;
+  std::vector<uint64_t> ts;
+  uint32_t uid = 0;
+  uint64_t now = 0;
+  auto insert = [&] (uint64_t t) {
+    records.push_back(app::LlnlEventRecord{t, uid++, app::LlnlEventRecord::INSERT});
+  };
+
+  // trace records of a client are read up front, bursts share their second
+  while (records.size() < pending) {
+    uint64_t second = traceSecond(rng);
+    int burst = 1 + kind(rng);
+    for (int b = 0; b < burst && records.size() < pending; b++) {
+      insert(second * SECOND);
+    }
+  }
+
+  // hold model: remove the next event, schedule one or two follow-ups
+  std::set<std::pair<uint64_t, uint32_t>> queue;
+  for (const auto& record : records) {
+    queue.insert(std::make_pair(record.ts, record.uid));
+  }
+  while (records.size() < operations && !queue.empty()) {
+    auto next = *queue.begin();
+    queue.erase(queue.begin());
+    now = next.first;
+    records.push_back(app::LlnlEventRecord{next.first, next.second, app::LlnlEventRecord::REMOVE_NEXT});
+    int follow = kind(rng) < 7 ? 1 : 2;
+    for (int f = 0; f < follow; f++) {
+      uint64_t t = kind(rng) < 9 ? now + static_cast<uint64_t>(packetDelay(rng))
+                                 : (now / SECOND + 1 + traceSecond(rng) / 100) * SECOND;
+      queue.insert(std::make_pair(t, uid));
+      insert(t);
+    }
+  }
+  return records;
+}
+
+static void
+Replay(const std::string& typeId, const std::vector<app::LlnlEventRecord>& records)
+{
+  ObjectFactory factory;
+  factory.SetTypeId(typeId);
+  Ptr<Scheduler> scheduler = factory.Create<Scheduler>();
+
+  uint64_t mismatches = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const auto& record : records) {
+    Scheduler::Event ev;
+    ev.impl = nullptr;
+    ev.key.m_ts = record.ts;
+    ev.key.m_uid = record.uid;
+    ev.key.m_context = 0;
+    switch (record.op) {
+    case app::LlnlEventRecord::INSERT:
+      scheduler->Insert(ev);
+      break;
+    case app::LlnlEventRecord::REMOVE_NEXT:
+      if (scheduler->RemoveNext().key.m_uid != record.uid) {
+        mismatches++;
+      }
+      break;
+    default:
+      scheduler->Remove(ev);
+      break;
+    }
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  while (!scheduler->IsEmpty()) {
+    scheduler->RemoveNext();
+  }
+
+  std::cout << std::left << std::setw(24) << typeId << std::right << std::setw(10) << std::fixed
+            << std::setprecision(3) << seconds << " s" << std::setw(10) << std::setprecision(1)
+            << seconds * 1e9 / records.size() << " ns/op";
+  if (mismatches > 0) {
+    std::cout << "  " << mismatches << " events out of recorded order";
+  }
+  std::cout << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+{
+  std::string trace;
+  std::string schedulers =
+    "ns3::MapScheduler,ns3::HeapScheduler,ns3::ListScheduler,ns3::CalendarScheduler,LlnlLadderScheduler";
+  uint64_t synthetic = 2000000;
+  uint64_t pending = 200000;
+  uint32_t seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue("trace", "Scheduler operations recorded with --eventTrace", trace);
+  cmd.AddValue("synthetic", "Operations of the synthetic workload, used without --trace", synthetic);
+  cmd.AddValue("pending", "Trace events scheduled up front in the synthetic workload", pending);
+  cmd.AddValue("seed", "Seed of the synthetic workload", seed);
+  cmd.AddValue("schedulers", "Comma-separated scheduler TypeIds to compare", schedulers);
+  cmd.Parse(argc, argv);
+
+  std::vector<app::LlnlEventRecord> records;
+  if (!trace.empty()) {
+    if (!app::ReadEventTrace(trace, records)) {
+      std::cout << "Cannot read event trace " << trace << std::endl;
+      return 1;
+    }
+  }
+  else {
+    records = MakeSynthetic(synthetic, pending, seed);
+  }
+  std::cout << records.size() << " operations" << std::endl;
+
+  std::vector<std::string> typeIds;
+  boost::split(typeIds, schedulers, boost::is_any_of(","));
+  for (const auto& typeId : typeIds) {
+    Replay(typeId, records);
+  }
+  return 0;
+}
+
+} // namespace ns3
+
+int
+main(int argc, char* argv[])
+{
+  return ns3::main(argc, argv);
+}
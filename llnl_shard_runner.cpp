@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_shard_runner.cpp
+//
+// Splits the trace week into time windows and runs one llnl_sim process per window,
+// each replaying its window plus a warm-up prefix, then adds up the per-window
+// metrics. Example:
+//
+//   llnl_shard_runner --sim="./build/llnl_sim --ntime=1443689480 --ncache=1000"
+//                     --shards=32 --jobs=32 --warmup=7200 --out=shards
+
+#include "llnl/llnl_run_metrics.hpp"
+#include "llnl/llnl_tools.hpp"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+
+int
+main(int argc, char* argv[])
+{
+  std::string sim;
+  std::string out = "shards";
+  std::string value;
+  int shards = 8;
+  int jobs = 0;
+  double start = 0;
+  double end = 605800;
+  double warmup = 3600;
+
+  for (int i = 1; i < argc; i++) {
+    if (app::parseOption(argv[i], "sim", value)) sim = value;
+    else if (app::parseOption(argv[i], "out", value)) out = value;
+    else if (app::parseOption(argv[i], "shards", value)) shards = std::atoi(value.c_str());
+    else if (app::parseOption(argv[i], "jobs", value)) jobs = std::atoi(value.c_str());
+    else if (app::parseOption(argv[i], "start", value)) start = std::atof(value.c_str());
+    else if (app::parseOption(argv[i], "end", value)) end = std::atof(value.c_str());
+    else if (app::parseOption(argv[i], "warmup", value)) warmup = std::atof(value.c_str());
+    else {
+      std::cout << "Unknown option " << argv[i] << std::endl;
+      return 1;
+    }
+  }
+  if (sim.empty() || shards <= 0 || end <= start) {
+    std::cout << "Usage: llnl_shard_runner --sim=\"<llnl_sim command>\" [--shards=K] [--jobs=N]"
+              << " [--start=s] [--end=s] [--warmup=s] [--out=dir]" << std::endl;
+    return 1;
+  }
+  if (jobs <= 0) {
+    jobs = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+  }
+  mkdir(out.c_str(), 0755);
+
+  double width = (end - start) / shards;
+  std::map<pid_t, int> running;
+  int next = 0;
+  int failed = 0;
+
+  while (next < shards || !running.empty()) {
+    while (next < shards && static_cast<int>(running.size()) < jobs) {
+      double windowStart = start + next * width;
+      double windowEnd = (next == shards - 1) ? end : windowStart + width;
+      std::string prefix = out + "/window-" + std::to_string(next);
+      std::string command = sim
+        + " --windowStart=" + std::to_string(windowStart)
+        + " --windowEnd=" + std::to_string(windowEnd)
+        + " --warmup=" + std::to_string(windowStart > start ? warmup : 0)
+        + " --metrics=" + prefix + ".metrics"
+        + " > " + prefix + ".log 2>&1";
+
+      pid_t pid = fork();
+      if (pid == 0) {
+        execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+      }
+      if (pid < 0) {
+        std::cout << "fork failed for window " << next << std::endl;
+        return 1;
+      }
+      std::cout << "Window " << next << " [" << windowStart << ", " << windowEnd << ") pid " << pid << std::endl;
+      running[pid] = next++;
+    }
+
+    int status = 0;
+    pid_t pid = waitpid(-1, &status, 0);
+    if (pid < 0) {
+      break;
+    }
+    auto it = running.find(pid);
+    if (it == running.end()) {
+      continue;
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      std::cout << "Window " << it->second << " failed with status " << status << std::endl;
+      failed++;
+    }
+    else {
+      std::cout << "Window " << it->second << " done" << std::endl;
+    }
+    running.erase(it);
+  }
+
+  app::LlnlRunMetrics merged;
+  for (int k = 0; k < shards; k++) {
+    app::LlnlRunMetrics window;
+    std::string fileName = out + "/window-" + std::to_string(k) + ".metrics";
+    if (!window.Read(fileName)) {
+      std::cout << "Missing metrics " << fileName << std::endl;
+      failed++;
+      continue;
+    }
+    merged.Merge(window);
+  }
+  merged.SetWindow(static_cast<int64_t>(start * 1e9), static_cast<int64_t>(end * 1e9));
+  merged.Write(out + "/merged.metrics");
+  merged.Write(std::cout);
+
+  return failed == 0 ? 0 : 1;
+}
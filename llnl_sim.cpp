@@ -20,6 +20,21 @@
  **/
 
 #include "llnl/llnl_client_starter.hpp"
+#include "llnl/llnl_checkpointer.hpp"
+#include "llnl/llnl_native_consumer.hpp"
+#include "llnl/llnl_heartbeat.hpp"
+#include "llnl/llnl_ladder_scheduler.hpp"
+#include "llnl/llnl_memory_sampler.hpp"
+#include "llnl/llnl_link_stats.hpp"
+#include "llnl/llnl_virtual_payload.hpp"
+#include "llnl/llnl_workload_scaling.hpp"
+#include "llnl/llnl_heavy_hitters.hpp"
+#include "llnl/llnl_phase_profiler.hpp"
+#include "llnl/llnl_instrumentation.hpp"
+#include "llnl/llnl_topology_pruner.hpp"
+#include "llnl/llnl_admission_cs.hpp"
+#include "llnl/llnl_cooperative_cache.hpp"
+#include "ndn-closer-site/cooperative-edge-strategy.hpp"
 
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
@@ -41,27 +56,190 @@
 namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED(LlnlClientStarter);
+NS_OBJECT_ENSURE_REGISTERED(LlnlNativeConsumer);
+NS_OBJECT_ENSURE_REGISTERED(LlnlCountingScheduler);
+NS_OBJECT_ENSURE_REGISTERED(LlnlLadderScheduler);
+NS_OBJECT_ENSURE_REGISTERED(LlnlTinyLfuContentStore);
 
 int
 main(int argc, char* argv[])
 {
     int nCache = 0;
     int timestamp;
+    double stopTime = 605800;
+    double checkpointInterval = 0;
+    double checkpointAt = 0;
+    std::string checkpointDir = ".";
+    std::string resumeDir;
+    double windowStart = 0;
+    double windowEnd = 0;
+    double warmup = 0;
+    std::string metricsFile;
+    bool native = false;
+    double heartbeat = 0;
+    std::string heartbeatJson;
+    uint64_t heartbeatEvents = 4096;
+    std::string scheduler = "ns3::MapScheduler";
+    std::string eventTrace;
+    double memInterval = 0;
+    std::string memFile = "memory.tsv";
+    uint32_t memTopN = 10;
+    std::string linkStatsFile;
+    double linkBucket = 60;
+    std::string completionFile;
+    std::string heavyHittersFile;
+    uint32_t heavyHittersK = 10;
+    uint32_t heavyHittersCounters = 100;
+    double heavyHittersInterval = 3600;
+    bool virtualPayload = false;
+    double timeCompression = 1;
+    std::string profileFile;
+    std::string prunedTopology;
+    bool admission = false;
+    std::string admissionNodes;
+    std::string admissionStats;
+    bool coop = false;
+    LlnlCooperativeCache::Parameters coopParams;
+    double coopBudget = coopParams.budget.GetMilliSeconds();
+    double coopInterval = coopParams.interval.GetSeconds();
+    std::string coopStats;
+    double clientFraction = 1;
+    double thinning = 1;
+    uint32_t scalingSeed = 1;
     CommandLine cmd;
     cmd.AddValue("ncache", "Number of Cache Slots", nCache);
     cmd.AddValue("ntime", "timestamp", timestamp);
+    cmd.AddValue("checkpointInterval", "Simulated seconds between checkpoints, 0 disables", checkpointInterval);
+    cmd.AddValue("checkpointAt", "Extra checkpoint time in seconds, e.g. end of warm-up", checkpointAt);
+    cmd.AddValue("checkpointDir", "Directory checkpoints are written to", checkpointDir);
+    cmd.AddValue("resume", "Resume from the latest checkpoint in this directory", resumeDir);
+    cmd.AddValue("windowStart", "Start of the measured time window in seconds", windowStart);
+    cmd.AddValue("windowEnd", "End of the time window in seconds, 0 runs the whole trace", windowEnd);
+    cmd.AddValue("warmup", "Seconds of trace replayed before windowStart without counting", warmup);
+    cmd.AddValue("metrics", "File the run metrics are written to", metricsFile);
+    cmd.AddValue("native", "Use the lightweight ns-3 native consumer", native);
+    cmd.AddValue("heartbeat", "Wall-clock seconds between progress heartbeats, 0 disables", heartbeat);
+    cmd.AddValue("heartbeatJson", "File rewritten with the latest heartbeat", heartbeatJson);
+    cmd.AddValue("heartbeatEvents", "Executed events between wall-clock checks for the heartbeat", heartbeatEvents);
+    cmd.AddValue("scheduler", "Event scheduler TypeId, e.g. ns3::HeapScheduler or LlnlLadderScheduler", scheduler);
+    cmd.AddValue("eventTrace", "File the scheduler operations are recorded to for llnl_scheduler_bench", eventTrace);
+    cmd.AddValue("memInterval", "Simulated seconds between table memory samples, 0 disables", memInterval);
+    cmd.AddValue("memFile", "Time series of per-node table memory", memFile);
+    cmd.AddValue("memTopN", "Nodes listed in the table memory summary", memTopN);
+    cmd.AddValue("linkStats", "Binary file of per-link byte and queue counters, empty disables", linkStatsFile);
+    cmd.AddValue("linkBucket", "Width of the link counter time buckets in seconds", linkBucket);
+    cmd.AddValue("completion", "File the dataset completion-time distributions are written to", completionFile);
+    cmd.AddValue("heavyHitters", "File the top datasets per edge node and globally are written to", heavyHittersFile);
+    cmd.AddValue("heavyHittersK", "Datasets listed per snapshot", heavyHittersK);
+    cmd.AddValue("heavyHittersCounters", "Counters per space-saving summary, at least heavyHittersK", heavyHittersCounters);
+    cmd.AddValue("heavyHittersInterval", "Simulated seconds between top-K snapshots, 0 for one at the end", heavyHittersInterval);
+    cmd.AddValue("virtualPayload", "Send Data with the logical size of its segment", virtualPayload);
+    cmd.AddValue("profile", "JSON file the wall-clock and memory profile of each phase is written to", profileFile);
+    cmd.AddValue("admission", "Put a TinyLFU admission filter in front of the edge caches", admission);
+    cmd.AddValue("admissionNodes", "File of the edge nodes that get the admission filter, default all", admissionNodes);
+    cmd.AddValue("admissionStats", "File the per-node admission statistics are written to", admissionStats);
+    cmd.AddValue("coop", "Forward edge cache misses to neighbour edge caches that hold the segment", coop);
+    cmd.AddValue("coopBudget", "One-way delay in ms up to which another edge node is a neighbour", coopBudget);
+    cmd.AddValue("coopInterval", "Seconds between exchanges of the edge cache summaries", coopInterval);
+    cmd.AddValue("coopNeighbours", "Nearest neighbour edge nodes whose summaries are kept", coopParams.maxNeighbours);
+    cmd.AddValue("coopBits", "Bloom filter bits per cache slot in the summaries", coopParams.bitsPerEntry);
+    cmd.AddValue("coopStats", "File the per-node cooperative caching statistics are written to", coopStats);
+    cmd.AddValue("prunedTopology", "Prune the topology to client-producer paths into this file, with a .map of the nodes", prunedTopology);
+    cmd.AddValue("timeCompression", "Divide trace time offsets by this factor", timeCompression);
+    cmd.AddValue("clientFraction", "Fraction of the clients that replay their trace", clientFraction);
+    cmd.AddValue("thinning", "Fraction of each client's requests per dataset that is replayed", thinning);
+    cmd.AddValue("scalingSeed", "Seed of the client sampling and request thinning", scalingSeed);
     cmd.Parse(argc, argv);
+    LlnlPhaseProfiler profiler;
+    profiler.Start("setup");
     std::cout << "Cache Slots" << nCache << "Timestamp" << timestamp <<  std::endl;
     auto timestamp_str = std::to_string(timestamp);
 
+    if (!linkStatsFile.empty() && Seconds(linkBucket).GetNanoSeconds() <= 0) {
+        std::cout << "Link buckets must be at least a nanosecond wide" << std::endl;
+        return 1;
+    }
+
+    // a compressed week ends earlier; windows are given in compressed time
+    app::LlnlWorkloadScaling::Get().Configure(timeCompression, clientFraction, thinning, scalingSeed);
+    if (!heavyHittersFile.empty() &&
+        !app::LlnlHeavyHitters::Get().Configure(heavyHittersFile, heavyHittersK, heavyHittersCounters,
+                                                Seconds(heavyHittersInterval).GetNanoSeconds())) {
+        std::cout << "Cannot write heavy hitters to " << heavyHittersFile << std::endl;
+        return 1;
+    }
+    stopTime /= app::LlnlWorkloadScaling::Get().GetTimeCompression();
+    if (app::LlnlWorkloadScaling::Get().IsScaled()) {
+        app::LlnlWorkloadScaling::Get().PrintSettings(std::cout);
+    }
+
+    // time-window shard: replay [windowStart - warmup, windowEnd) and only count
+    // what happens from windowStart on
+    Time replayBegin = Seconds(0);
+    Time replayEnd = Time::Max();
+    if (windowEnd > 0) {
+        replayBegin = Seconds(std::max(0.0, windowStart - warmup));
+        replayEnd = Seconds(windowEnd);
+        stopTime = windowEnd;
+        app::LlnlRunMetrics::Get().SetWindow(Seconds(windowStart).GetNanoSeconds(),
+                                             Seconds(windowEnd).GetNanoSeconds());
+        std::cout << "Window " << windowStart << "s - " << windowEnd << "s, warm-up " << warmup << "s" << std::endl;
+    }
+
+    if (heartbeat > 0 || !eventTrace.empty()) {
+        LlnlHeartbeat::Configure(heartbeat, stopTime, heartbeatJson);
+        InstallCountingScheduler(scheduler, eventTrace, std::max<uint64_t>(heartbeatEvents, 1));
+    }
+    else {
+        ObjectFactory schedulerFactory;
+        schedulerFactory.SetTypeId(scheduler);
+        Simulator::SetScheduler(schedulerFactory);
+    }
+
+    if (native && (!resumeDir.empty() || checkpointInterval > 0 || checkpointAt > 0)) {
+        std::cout << "Checkpoints are only supported with the default consumer" << std::endl;
+        return 1;
+    }
+
+    if (!resumeDir.empty()) {
+        auto checkpointFile = app::LlnlCheckpoint::FindLatest(resumeDir);
+        if (checkpointFile.empty() || !app::LlnlCheckpoint::Get().Load(checkpointFile)) {
+            std::cout << "No usable checkpoint in " << resumeDir << std::endl;
+            return 1;
+        }
+    }
+
     Config::SetDefault("ns3::PointToPointNetDevice::DataRate", StringValue("10Gbps"));
     Config::SetDefault("ns3::DropTailQueue::MaxPackets", StringValue("3000000"));
     Config::SetDefault("ns3::PointToPointNetDevice::Mtu", UintegerValue(1500));
 
+    //auto topologyFilename = "/raid/LLNL_ACCESS_LOG/traceroute_data/create_asn_topology_for_ndnsim/ndnsim_large_topology_started_1.0.txt";
+    std::string topologyFilename = "/raid/LLNL_ACCESS_LOG/run_week_"+timestamp_str+"/"+timestamp_str + "week.csv.topology";
+    //auto clientFilename =  "/raid/LLNL_ACCESS_LOG/client_addresses_started_1.0.txt";
+    //auto clientFilename =  "/raid/LLNL_ACCESS_LOG/out.clientlist.txt";
+    auto clientFilename =  "/raid/LLNL_ACCESS_LOG/run_week_"+timestamp_str+"/" + timestamp_str +"week.csv.clients";
+
+    if (!prunedTopology.empty()) {
+        profiler.Start("topology_prune");
+        app::LlnlTopologyPruner pruner;
+        if (!pruner.Read(topologyFilename) || !pruner.ReadTerminals(clientFilename, app::LlnlTopologyPruner::CLIENT)) {
+            std::cout << "Cannot read the topology or clients file for pruning" << std::endl;
+            return 1;
+        }
+        pruner.AddTerminal("1.1.1.1", app::LlnlTopologyPruner::PRODUCER);
+        pruner.Prune();
+        pruner.PrintSummary(std::cout);
+        if (!pruner.Write(prunedTopology, prunedTopology + ".map")) {
+            std::cout << "Cannot write " << prunedTopology << std::endl;
+            return 1;
+        }
+        topologyFilename = prunedTopology;
+    }
+
+    profiler.Start("topology_read");
     //read the topology
     AnnotatedTopologyReader topologyReader("");
-    //topologyReader.SetFileName("/raid/LLNL_ACCESS_LOG/traceroute_data/create_asn_topology_for_ndnsim/ndnsim_large_topology_started_1.0.txt");
-    topologyReader.SetFileName("/raid/LLNL_ACCESS_LOG/run_week_"+timestamp_str+"/"+timestamp_str + "week.csv.topology");
+    topologyReader.SetFileName(topologyFilename);
     topologyReader.Read();
 
     std::string dict_name = "/raid/LLNL_ACCESS_LOG/run_week_"+ timestamp_str + "/";
@@ -70,6 +248,9 @@ main(int argc, char* argv[])
 
     ndn::StackHelper ndnHelper;
     ndnHelper.SetDefaultRoutes(true);
+    if (virtualPayload) {
+        LlnlVirtualPayloadTransport::Install(ndnHelper);
+    }
 
    // ndnHelper.setCsSize(1);
    // 1525,7625,15250
@@ -78,11 +259,8 @@ main(int argc, char* argv[])
 
     // Getting containers for the consumer/producer
 
+    profiler.Start("client_list");
     std::vector<std::string> clients;
-    //auto clientFilename =  "/raid/LLNL_ACCESS_LOG/client_addresses_started_1.0.txt";
-    //auto clientFilename =  "/raid/LLNL_ACCESS_LOG/out.clientlist.txt";
-    auto clientFilename =  "/raid/LLNL_ACCESS_LOG/run_week_"+timestamp_str+"/" + timestamp_str +"week.csv.clients";
-
     std::ifstream is(clientFilename);
     std::string line;
     while(getline(is, line)){
@@ -97,6 +275,7 @@ main(int argc, char* argv[])
     std::cout  << "Vector size " << clients.size();
 
 
+    profiler.Start("node_classification");
     //set caches everywhere else
     NodeContainer allOtherNodes;
     NodeContainer edgeNodes;
@@ -111,6 +290,7 @@ main(int argc, char* argv[])
             }
     }
 
+    profiler.Start("stack_install_network");
     ndnHelper.SetOldContentStore("ns3::ndn::cs::Nocache");
 //    ndnHelper.SetOldContentStore("ns3::ndn::cs::Lru", "MaxSize", std::to_string(nCache));
     //ndnHelper.setCsSize(nCache);
@@ -122,16 +302,30 @@ main(int argc, char* argv[])
     //ndnHelper.SetOldContentStore("ns3::ndn::cs::Nocache");
     //ndnHelper.setCsSize(nCache);
     //ndnHelper.setPolicy("nfd::cs::lru");
-    ndnHelper.SetOldContentStore("ns3::ndn::cs::Lru", "MaxSize", std::to_string(nCache));
-    ndnHelper.Install(edgeNodes);
+    profiler.Start("stack_install_edge");
+    LlnlTinyLfuContentStore::InstallEdgeStores(ndnHelper, edgeNodes, nCache, admission, admissionNodes);
+
+    if (app::LlnlCheckpoint::Get().IsLoaded()) {
+        LlnlCheckpointer::RestoreContentStores();
+    }
 
+    profiler.Start("strategy_and_routing_install");
     // Choosing forwarding strategy
-    ndn::StrategyChoiceHelper::InstallAll("/cmip5/app", "/localhost/nfd/strategy/best-route");
+    if (coop) {
+        ndn::StrategyChoiceHelper::InstallAll<nfd::fw::CooperativeEdgeStrategy>("/cmip5/app");
+        coopParams.budget = MilliSeconds(coopBudget);
+        coopParams.interval = Seconds(coopInterval);
+        LlnlCooperativeCache::Get().Configure(edgeNodes, nCache, coopParams);
+    }
+    else {
+        ndn::StrategyChoiceHelper::InstallAll("/cmip5/app", "/localhost/nfd/strategy/best-route");
+    }
 
     // Installing global routing interface on all nodes
     ndn::GlobalRoutingHelper ndnGlobalRoutingHelper;
     ndnGlobalRoutingHelper.InstallAll();
 
+    profiler.Start("app_install");
     //create producer
     Ptr<Node> producer = Names::Find<Node>("1.1.1.1");
     ndn::AppHelper producerApp("ns3::ndn::Producer");
@@ -146,20 +340,28 @@ main(int argc, char* argv[])
     Ptr<Node> consumers[clients.size()];
 
     int index = 0;
-    ndn::AppHelper consumerApp("LlnlClientStarter");
+    ndn::AppHelper consumerApp(native ? "LlnlNativeConsumer" : "LlnlClientStarter");
     for (const auto x: clients) {
+        if (!app::LlnlWorkloadScaling::Get().SampleClient(x)) {
+            continue;
+        }
         consumers[index] = Names::Find<Node>(x);
         auto ID =  Names::Find<Node>(x)->GetId();
         std::cout << "IP " << x << " ID " << ID << std::endl;
         consumerApp.SetAttribute("IP" , StringValue(x));
-        consumerApp.SetAttribute("ID" , StringValue(std::to_string(ID)));
+        if (!native) {
+            consumerApp.SetAttribute("ID" , StringValue(std::to_string(ID)));
+        }
         consumerApp.SetAttribute("DICT" , StringValue(dict_name));
         consumerApp.SetAttribute("TIMESTAMP" , StringValue(timestamp_str));
+        consumerApp.SetAttribute("WindowBegin" , TimeValue(replayBegin));
+        consumerApp.SetAttribute("WindowEnd" , TimeValue(replayEnd));
         //install Consumer App
         consumerApp.Install(consumers[index]).Start(Seconds(3));
         index++;
     }
 
+    profiler.Start("route_calculation");
     //add origin
     ndnGlobalRoutingHelper.AddOrigins("/cmip5/app", producer);
 
@@ -173,9 +375,75 @@ main(int argc, char* argv[])
     std::cout << "Calculated routes" << now1 << std::endl;
 
 
-    Simulator::Stop(Seconds(605800));
+    profiler.Start("instrumentation");
+    std::set<double> checkpointTimes;
+    if (checkpointAt > 0) {
+        checkpointTimes.insert(checkpointAt);
+    }
+    if (checkpointInterval > 0 || !checkpointTimes.empty()) {
+        LlnlCheckpointer::Schedule(checkpointDir, checkpointInterval, checkpointTimes, stopTime);
+    }
+
+    if (!linkStatsFile.empty()) {
+        LlnlLinkStats::Get().Install(topologyReader, Seconds(linkBucket));
+    }
+
+    if (memInterval > 0) {
+        LlnlMemorySampler::Get().Start(Seconds(memInterval), memFile, memTopN);
+    }
+
+    profiler.Start("run");
+    Simulator::Stop(Seconds(stopTime));
     Simulator::Run();
+    profiler.Start("output");
+
+    if (memInterval > 0) {
+        LlnlMemorySampler::Get().PrintSummary(std::cout);
+        LlnlMemorySampler::Get().Stop();
+    }
+
+    if (!linkStatsFile.empty()) {
+        LlnlLinkStats::Get().PrintTop(std::cout, 10);
+        LlnlLinkStats::Get().Write(linkStatsFile);
+    }
+
+    if (app::LlnlWorkloadScaling::Get().IsScaled()) {
+        app::LlnlWorkloadScaling::Get().PrintReport(std::cout);
+    }
+
+    app::LlnlHeavyHitters::Get().Finish(Simulator::Now().GetNanoSeconds());
+
+    if (!completionFile.empty()) {
+        FinishDownloads();
+        if (!app::LlnlCompletionStats::Get().Write(completionFile)) {
+            std::cout << "Failed to write completion times to " << completionFile << std::endl;
+        }
+    }
+
+    if (coop) {
+        LlnlCooperativeCache::Get().PrintSummary(std::cout);
+        if (!coopStats.empty()) {
+            LlnlCooperativeCache::Get().WriteStats(coopStats);
+        }
+    }
+
+    if (!admissionStats.empty()) {
+        LlnlTinyLfuContentStore::WriteStats(admissionStats);
+    }
+
+    if (!metricsFile.empty() && !app::LlnlRunMetrics::Get().Write(metricsFile)) {
+        std::cout << "Failed to write metrics to " << metricsFile << std::endl;
+    }
+
+    app::LlnlInstrumentation::Dump(std::cout);
+
+    profiler.Start("destroy");
     Simulator::Destroy();
+    profiler.Stop();
+    profiler.Print(std::cout);
+    if (!profileFile.empty() && !profiler.Write(profileFile)) {
+        std::cout << "Failed to write the phase profile to " << profileFile << std::endl;
+    }
     return 0;
 }
 
@@ -25,7 +25,24 @@
 #include "ns3/ndnSIM-module.h"
 
 #include "ndn-closer-site/closer-site-strategy.hpp"
+#include "ndn-closer-site/load-aware-site-strategy.hpp"
+#include "ndn-closer-site/site-producer.hpp"
+#include "ndn-closer-site/k-best-routing-helper.hpp"
+#include "ndn-closer-site/dynamic-routing-helper.hpp"
+#include "ndn-closer-site/replica-routing-helper.hpp"
 #include "llnl/llnl_client_starter.hpp"
+#include "llnl/llnl_heartbeat.hpp"
+#include "llnl/llnl_ladder_scheduler.hpp"
+#include "llnl/llnl_memory_sampler.hpp"
+#include "llnl/llnl_link_stats.hpp"
+#include "llnl/llnl_virtual_payload.hpp"
+#include "llnl/llnl_workload_scaling.hpp"
+#include "llnl/llnl_heavy_hitters.hpp"
+#include "llnl/llnl_phase_profiler.hpp"
+#include "llnl/llnl_instrumentation.hpp"
+#include "llnl/llnl_topology_pruner.hpp"
+#include "llnl/llnl_admission_cs.hpp"
+#include "llnl/llnl_replica_placement.hpp"
 
 using namespace ns3;
 
@@ -36,6 +53,9 @@ using ns3::ndn::StrategyChoiceHelper;
 using ns3::AnnotatedTopologyReader;
 
 NS_OBJECT_ENSURE_REGISTERED(LlnlClientStarter);
+NS_OBJECT_ENSURE_REGISTERED(LlnlCountingScheduler);
+NS_OBJECT_ENSURE_REGISTERED(LlnlLadderScheduler);
+NS_OBJECT_ENSURE_REGISTERED(LlnlTinyLfuContentStore);
 
 int
 main(int argc, char* argv[])
@@ -44,38 +64,214 @@ main(int argc, char* argv[])
     int nCache = 0;
     int timestamp = 1443689480;
     uint32_t odds = 0;
+    double stopTime = 1000;
+    double heartbeat = 0;
+    std::string heartbeatJson;
+    uint64_t heartbeatEvents = 4096;
+    std::string scheduler = "ns3::MapScheduler";
+    std::string eventTrace;
+    double memInterval = 0;
+    std::string memFile = "memory.tsv";
+    uint32_t memTopN = 10;
+    std::string linkStatsFile;
+    double linkBucket = 60;
+    std::string completionFile;
+    std::string heavyHittersFile;
+    uint32_t heavyHittersK = 10;
+    uint32_t heavyHittersCounters = 100;
+    double heavyHittersInterval = 3600;
+    bool virtualPayload = false;
+    double timeCompression = 1;
+    std::string profileFile;
+    std::string prunedTopology;
+    bool admission = false;
+    std::string admissionNodes;
+    std::string admissionStats;
+    double clientFraction = 1;
+    double thinning = 1;
+    uint32_t scalingSeed = 1;
+    bool siteProducer = false;
+    std::string serverParams;
+    std::string diskRate = "10Gbps";
+    std::string egressRate = "10Gbps";
+    uint32_t concurrency = 8;
+    std::string discipline = "FIFO";
+    std::string serverStats;
+    std::string strategy = "closer-site";
+    uint32_t tolerance = 20;
+    uint32_t loadPenalty = 5;
+    std::string selection = "p2c";
+    uint32_t kRoutes = 0;
+    std::string placementFile;
+    std::string topologyFile;
+    std::string serverFile;
+    std::string clientFile;
+    std::string dictDir;
+    double windowStart = 0;
+    double windowEnd = 0;
+    double warmup = 0;
+    std::string metricsFile;
+    std::string routingEvents;
+    std::string routingReport;
+    double convergenceWindow = 10;
 
     CommandLine cmd;
     cmd.AddValue("ncache", "Number of Cache Slots", nCache);
     cmd.AddValue("ntime", "timestamp", timestamp);
     cmd.AddValue("odds", "failure rate on server", odds);
+    cmd.AddValue("stopTime", "Simulated seconds the scenario runs", stopTime);
+    cmd.AddValue("topology", "Topology file instead of the default week's", topologyFile);
+    cmd.AddValue("servers", "Servers file instead of the default week's", serverFile);
+    cmd.AddValue("clients", "Clients file instead of the default week's", clientFile);
+    cmd.AddValue("dict", "Directory of the client traces instead of the default week's", dictDir);
+    cmd.AddValue("windowStart", "Start of the measured time window in seconds", windowStart);
+    cmd.AddValue("windowEnd", "End of the time window in seconds, 0 runs until stopTime", windowEnd);
+    cmd.AddValue("warmup", "Seconds of trace replayed before windowStart without counting", warmup);
+    cmd.AddValue("metrics", "File the run metrics are written to", metricsFile);
+    cmd.AddValue("heartbeat", "Wall-clock seconds between progress heartbeats, 0 disables", heartbeat);
+    cmd.AddValue("heartbeatJson", "File rewritten with the latest heartbeat", heartbeatJson);
+    cmd.AddValue("heartbeatEvents", "Executed events between wall-clock checks for the heartbeat", heartbeatEvents);
+    cmd.AddValue("scheduler", "Event scheduler TypeId, e.g. ns3::HeapScheduler or LlnlLadderScheduler", scheduler);
+    cmd.AddValue("eventTrace", "File the scheduler operations are recorded to for llnl_scheduler_bench", eventTrace);
+    cmd.AddValue("memInterval", "Simulated seconds between table memory samples, 0 disables", memInterval);
+    cmd.AddValue("memFile", "Time series of per-node table memory", memFile);
+    cmd.AddValue("memTopN", "Nodes listed in the table memory summary", memTopN);
+    cmd.AddValue("linkStats", "Binary file of per-link byte and queue counters, empty disables", linkStatsFile);
+    cmd.AddValue("linkBucket", "Width of the link counter time buckets in seconds", linkBucket);
+    cmd.AddValue("completion", "File the dataset completion-time distributions are written to", completionFile);
+    cmd.AddValue("heavyHitters", "File the top datasets per edge node and globally are written to", heavyHittersFile);
+    cmd.AddValue("heavyHittersK", "Datasets listed per snapshot", heavyHittersK);
+    cmd.AddValue("heavyHittersCounters", "Counters per space-saving summary, at least heavyHittersK", heavyHittersCounters);
+    cmd.AddValue("heavyHittersInterval", "Simulated seconds between top-K snapshots, 0 for one at the end", heavyHittersInterval);
+    cmd.AddValue("virtualPayload", "Send Data with the logical size of its segment", virtualPayload);
+    cmd.AddValue("profile", "JSON file the wall-clock and memory profile of each phase is written to", profileFile);
+    cmd.AddValue("admission", "Put a TinyLFU admission filter in front of the edge caches", admission);
+    cmd.AddValue("admissionNodes", "File of the edge nodes that get the admission filter, default all", admissionNodes);
+    cmd.AddValue("admissionStats", "File the per-node admission statistics are written to", admissionStats);
+    cmd.AddValue("prunedTopology", "Prune the topology to client-server paths into this file, with a .map of the nodes", prunedTopology);
+    cmd.AddValue("timeCompression", "Divide trace time offsets by this factor", timeCompression);
+    cmd.AddValue("clientFraction", "Fraction of the clients that replay their trace", clientFraction);
+    cmd.AddValue("thinning", "Fraction of each client's requests per dataset that is replayed", thinning);
+    cmd.AddValue("scalingSeed", "Seed of the client sampling and request thinning", scalingSeed);
+    cmd.AddValue("siteProducer", "Serve Interests with the capacity-modelled SiteProducer", siteProducer);
+    cmd.AddValue("serverParams", "Per-server parameters, defaults to the servers file with .params appended", serverParams);
+    cmd.AddValue("diskRate", "Default server disk rate", diskRate);
+    cmd.AddValue("egressRate", "Default server egress rate", egressRate);
+    cmd.AddValue("concurrency", "Default number of segments a server serves at once", concurrency);
+    cmd.AddValue("discipline", "Default server queue discipline, FIFO or PS", discipline);
+    cmd.AddValue("serverStats", "File the server queue and utilisation statistics are written to", serverStats);
+    cmd.AddValue("strategy", "Site selection strategy, closer-site, load-aware or best-route", strategy);
+    cmd.AddValue("tolerance", "load-aware: ms a site may be slower than the closest one and still be used", tolerance);
+    cmd.AddValue("loadPenalty", "load-aware: ms added to a site's score per outstanding Interest", loadPenalty);
+    cmd.AddValue("selection", "load-aware: p2c (power of two choices) or weighted", selection);
+    cmd.AddValue("placement", "Dataset replica placement; datasets are advertised only by their replicas", placementFile);
+    cmd.AddValue("kRoutes", "Install at most this many next hops per prefix per node, 0 installs every face", kRoutes);
+    cmd.AddValue("routingEvents", "File of scheduled link down/up and producer withdraw/announce events", routingEvents);
+    cmd.AddValue("routingReport", "File the cost and impact of each routing event is written to", routingReport);
+    cmd.AddValue("convergenceWindow", "Seconds before and after a routing event its timeouts and Nacks are counted", convergenceWindow);
     cmd.Parse(argc, argv);
+    LlnlPhaseProfiler profiler;
+    profiler.Start("setup");
     std::cout << "Cache Slots " << nCache << "Timestamp " << timestamp << " odds: " << odds << std::endl;
 
+    if (!linkStatsFile.empty() && Seconds(linkBucket).GetNanoSeconds() <= 0) {
+        std::cout << "Link buckets must be at least a nanosecond wide" << std::endl;
+        return 1;
+    }
+
+    app::LlnlWorkloadScaling::Get().Configure(timeCompression, clientFraction, thinning, scalingSeed);
+    if (!heavyHittersFile.empty() &&
+        !app::LlnlHeavyHitters::Get().Configure(heavyHittersFile, heavyHittersK, heavyHittersCounters,
+                                                Seconds(heavyHittersInterval).GetNanoSeconds())) {
+        std::cout << "Cannot write heavy hitters to " << heavyHittersFile << std::endl;
+        return 1;
+    }
+    if (app::LlnlWorkloadScaling::Get().IsScaled()) {
+        app::LlnlWorkloadScaling::Get().PrintSettings(std::cout);
+    }
+
+    // time window as in llnl_sim, so both forwarding setups can be compared on one
+    Time replayBegin = Seconds(0);
+    Time replayEnd = Time::Max();
+    if (windowEnd > 0) {
+        replayBegin = Seconds(std::max(0.0, windowStart - warmup));
+        replayEnd = Seconds(windowEnd);
+        stopTime = windowEnd;
+        app::LlnlRunMetrics::Get().SetWindow(Seconds(windowStart).GetNanoSeconds(),
+                                             Seconds(windowEnd).GetNanoSeconds());
+        std::cout << "Window " << windowStart << "s - " << windowEnd << "s, warm-up " << warmup << "s" << std::endl;
+    }
+
+    if (heartbeat > 0 || !eventTrace.empty()) {
+        LlnlHeartbeat::Configure(heartbeat, stopTime, heartbeatJson);
+        InstallCountingScheduler(scheduler, eventTrace, std::max<uint64_t>(heartbeatEvents, 1));
+    }
+    else {
+        ObjectFactory schedulerFactory;
+        schedulerFactory.SetTypeId(scheduler);
+        Simulator::SetScheduler(schedulerFactory);
+    }
+
     auto timestamp_str = std::to_string(timestamp);
 
     Config::SetDefault("ns3::PointToPointNetDevice::DataRate", StringValue("10Gbps"));
     Config::SetDefault("ns3::DropTailQueue::MaxPackets", StringValue("3000000"));
     Config::SetDefault("ns3::PointToPointNetDevice::Mtu", UintegerValue(1500));
 
+    std::string topologyFilename = "/raid/ndnSIM_final/ns-3/topo/1443689480week.csv.topology.2.new-topo";
+    std::string serverFilename = "/raid/ndnSIM_final/ns-3/topo/1443689480week.csv.servers";
+    std::string clientFilename = "/raid/ndnSIM_final/ns-3/topo/1443689480week.csv.clients";
+    if (!topologyFile.empty()) {
+        topologyFilename = topologyFile;
+    }
+    if (!serverFile.empty()) {
+        serverFilename = serverFile;
+    }
+    if (!clientFile.empty()) {
+        clientFilename = clientFile;
+    }
+
+    if (!prunedTopology.empty()) {
+        profiler.Start("topology_prune");
+        app::LlnlTopologyPruner pruner;
+        if (!pruner.Read(topologyFilename) || !pruner.ReadTerminals(serverFilename, app::LlnlTopologyPruner::PRODUCER) ||
+            !pruner.ReadTerminals(clientFilename, app::LlnlTopologyPruner::CLIENT)) {
+            std::cout << "Cannot read the topology, servers or clients file for pruning" << std::endl;
+            return 1;
+        }
+        pruner.Prune();
+        pruner.PrintSummary(std::cout);
+        if (!pruner.Write(prunedTopology, prunedTopology + ".map")) {
+            std::cout << "Cannot write " << prunedTopology << std::endl;
+            return 1;
+        }
+        topologyFilename = prunedTopology;
+    }
+
+    profiler.Start("topology_read");
     //read the topology
     AnnotatedTopologyReader topologyReader("");
-    topologyReader.SetFileName("/raid/ndnSIM_final/ns-3/topo/1443689480week.csv.topology.2.new-topo");
+    topologyReader.SetFileName(topologyFilename);
     topologyReader.Read();
 
     // okay to use the clients file
     std::string dict_name = "/raid/LLNL_ACCESS_LOG/run_week_"+ timestamp_str + "_balancer/";
+    if (!dictDir.empty()) {
+        dict_name = dictDir + "/";
+    }
 
     // Install NDN stack on all nodes
     StackHelper ndnHelper;
+    if (virtualPayload) {
+        LlnlVirtualPayloadTransport::Install(ndnHelper);
+    }
     //ndnHelper.InstallAll();
 
     ////////////////////////////////
     /////////// Servers ////////////
     ////////////////////////////////
+    profiler.Start("server_list");
     std::vector<std::string> servers;
-    auto serverFilename =  "/raid/ndnSIM_final/ns-3/topo/1443689480week.csv.servers";
-
     std::ifstream is1(serverFilename);
     std::string line;
     while(getline(is1, line)){
@@ -90,9 +286,8 @@ main(int argc, char* argv[])
     ////////////////////////////////
     /////////// Clients ////////////
     ////////////////////////////////
+    profiler.Start("client_list");
     std::vector<std::string> clients;
-    auto clientFilename =  "/raid/ndnSIM_final/ns-3/topo/1443689480week.csv.clients";
-
     std::ifstream is2(clientFilename);
     while(getline(is2, line)){
         clients.push_back(line);
@@ -105,6 +300,7 @@ main(int argc, char* argv[])
 
     std::cout  << "Vector size " << clients.size();
 
+    profiler.Start("node_classification");
     //set caches everywhere else
     NodeContainer allOtherNodes;
     NodeContainer edgeNodes;
@@ -119,31 +315,65 @@ main(int argc, char* argv[])
             }
     }
 
+    profiler.Start("stack_install_network");
     ndnHelper.SetOldContentStore("ns3::ndn::cs::Nocache");
     ndnHelper.Install(allOtherNodes);
-    ndnHelper.SetOldContentStore("ns3::ndn::cs::Lru", "MaxSize", std::to_string(nCache));
-    ndnHelper.Install(edgeNodes);
+    profiler.Start("stack_install_edge");
+    LlnlTinyLfuContentStore::InstallEdgeStores(ndnHelper, edgeNodes, nCache, admission, admissionNodes);
 
+    profiler.Start("strategy_and_routing_install");
     // Choosing forwarding strategy
     // Install NDN applications
     std::string prefix = "/cmip5/app";
 
-    ns3::ndn::StrategyChoiceHelper::InstallAll(prefix, "/localhost/nfd/strategy/closer-site");
+    if (strategy == "load-aware") {
+        auto& params = nfd::fw::LoadAwareSiteStrategy::getParameters();
+        params.tolerance = ::ndn::time::milliseconds(tolerance);
+        params.loadPenalty = ::ndn::time::milliseconds(loadPenalty);
+        params.selection = selection == "weighted" ? nfd::fw::LoadAwareSiteStrategy::WEIGHTED
+                                                   : nfd::fw::LoadAwareSiteStrategy::POWER_OF_TWO;
+        StrategyChoiceHelper::InstallAll<nfd::fw::LoadAwareSiteStrategy>(prefix);
+    }
+    else if (strategy == "best-route") {
+        ns3::ndn::StrategyChoiceHelper::InstallAll(prefix, "/localhost/nfd/strategy/best-route");
+    }
+    else {
+        ns3::ndn::StrategyChoiceHelper::InstallAll(prefix, "/localhost/nfd/strategy/closer-site");
+    }
 
     // Installing global routing interface on all nodes
     GlobalRoutingHelper ndnGlobalRoutingHelper;
     ndnGlobalRoutingHelper.InstallAll();
 
+    profiler.Start("app_install");
     //create producer
     Ptr<Node> producers[servers.size()];
-    ns3::ndn::AppHelper producerApp("ns3::ndn::Producer");
+    ns3::ndn::AppHelper producerApp(siteProducer ? "ns3::ndn::SiteProducer" : "ns3::ndn::Producer");
     producerApp.SetAttribute("PayloadSize", StringValue("1"));//doesn't matter really
     producerApp.SetAttribute("Freshness", StringValue("1000"));
     producerApp.SetAttribute("Prefix", StringValue("/cmip5/app"));
+
+    // disk rate, egress rate, concurrency and discipline per server
+    std::map<std::string, std::vector<std::string>> params;
+    if (siteProducer) {
+        params = ns3::ndn::SiteProducer::ReadParams(serverParams.empty() ? serverFilename + ".params"
+                                                                         : serverParams);
+    }
     int index = 0;
     for (const auto x: servers) {
         producers[index] = Names::Find<Node>(x);
         std::cout << "producer " << x << " on " << producers[index]->GetId() << std::endl;
+        if (siteProducer) {
+            auto p = params.find(x);
+            std::vector<std::string> server = p != params.end() ? p->second :
+              std::vector<std::string>{diskRate, egressRate, std::to_string(concurrency), discipline};
+            producerApp.SetAttribute("DiskRate", DataRateValue(DataRate(server[0])));
+            producerApp.SetAttribute("EgressRate", DataRateValue(DataRate(server[1])));
+            producerApp.SetAttribute("Concurrency", UintegerValue(std::stoul(server[2])));
+            producerApp.SetAttribute("Discipline", StringValue(server[3]));
+            std::cout << "producer " << x << " disk " << server[0] << " egress " << server[1]
+                      << " concurrency " << server[2] << " " << server[3] << std::endl;
+        }
         producerApp.Install(producers[index]).Start(Seconds(0));
         index++;
     }
@@ -153,6 +383,9 @@ main(int argc, char* argv[])
     index = 0;
     ns3::ndn::AppHelper consumerApp("LlnlClientStarter");
     for (const auto x: clients) {
+        if (!app::LlnlWorkloadScaling::Get().SampleClient(x)) {
+            continue;
+        }
         consumers[index] = Names::Find<Node>(x);
         auto ID =  Names::Find<Node>(x)->GetId();
         std::cout << "IP " << x << " ID " << ID << std::endl;
@@ -160,11 +393,14 @@ main(int argc, char* argv[])
         consumerApp.SetAttribute("ID" , StringValue(std::to_string(ID)));
         consumerApp.SetAttribute("DICT" , StringValue(dict_name));
         consumerApp.SetAttribute("TIMESTAMP" , StringValue(timestamp_str));
+        consumerApp.SetAttribute("WindowBegin" , TimeValue(replayBegin));
+        consumerApp.SetAttribute("WindowEnd" , TimeValue(replayEnd));
         //install Consumer App
         consumerApp.Install(consumers[index]).Start(Seconds(0));
         index++;
     }
 
+    profiler.Start("route_calculation");
     //add origin 
     index = 0;
     for (const auto x: servers) {
@@ -172,19 +408,136 @@ main(int argc, char* argv[])
         index++;
     }
 
+    // every server keeps answering /cmip5/app, but a placed dataset is routed to its
+    // replicas by the longer /cmip5/app/<dataset> prefix; datasets missing from the
+    // placement still go to the closest server
+    ns3::ndn::ReplicaRoutingHelper replicaRouting;
+    if (!placementFile.empty()) {
+        auto placement = app::LlnlReplicaPlacement::ReadPlacement(placementFile);
+        for (const auto& dataset : placement) {
+            for (const auto& server : dataset.second) {
+                Ptr<Node> node = Names::Find<Node>(server);
+                if (node == nullptr || std::find(servers.begin(), servers.end(), server) == servers.end()) {
+                    std::cout << "Placement of " << dataset.first << " on unknown server " << server << std::endl;
+                    continue;
+                }
+                replicaRouting.AddReplica(ndnGlobalRoutingHelper, prefix + "/" + dataset.first, node);
+            }
+        }
+        std::cout << "Placement: " << placement.size() << " datasets, " << replicaRouting.GetNReplicas()
+                  << " replicas" << std::endl;
+    }
+
     // Calculate and install FIBs
     auto now = ns3::Simulator::Now().To(ns3::Time::S);
     std::cout << "Calculating routes" << now << std::endl;
 
     // Calculate and install FIBs
     // http://www.lists.cs.ucla.edu/pipermail/ndnsim/2016-May/002707.html
-    GlobalRoutingHelper::CalculateAllPossibleRoutes();
+    // routes that follow scheduled events keep their shortest-path state for the run
+    std::unique_ptr<ns3::ndn::DynamicRoutingHelper> dynamicRouting;
+    if (!routingEvents.empty()) {
+        dynamicRouting.reset(new ns3::ndn::DynamicRoutingHelper(kRoutes));
+        auto routes = dynamicRouting->CalculateRoutes();
+        std::cout << "Dynamic routes: " << routes.prefixes << " prefixes, " << routes.routes << " next hops"
+                  << std::endl;
+        auto inFlight = [] {
+            uint64_t outstanding = 0;
+            for (NodeList::Iterator node = NodeList::Begin(); node != NodeList::End(); ++node) {
+                for (uint32_t a = 0; a < (*node)->GetNApplications(); a++) {
+                    Ptr<LlnlClientStarter> starter = DynamicCast<LlnlClientStarter>((*node)->GetApplication(a));
+                    if (starter != nullptr && starter->GetConsumer() != nullptr) {
+                        outstanding += starter->GetConsumer()->getOutstandingCount();
+                    }
+                }
+            }
+            return outstanding;
+        };
+        auto losses = [] {
+            return app::LlnlRunMetrics::Get().timeouts + app::LlnlRunMetrics::Get().nacks;
+        };
+        dynamicRouting->SetImpactCounters(inFlight, losses, Seconds(convergenceWindow));
+        if (!dynamicRouting->ScheduleEvents(routingEvents)) {
+            return 1;
+        }
+    }
+    else if (kRoutes > 0) {
+        auto routes = ns3::ndn::KBestRoutingHelper::CalculateRoutes(kRoutes);
+        std::cout << "K-best routes: " << routes.prefixes << " prefixes, " << routes.routes
+                  << " next hops, at most " << kRoutes << " of up to " << routes.maxNextHops << " per node"
+                  << std::endl;
+    }
+    else {
+        GlobalRoutingHelper::CalculateAllPossibleRoutes();
+    }
+    // a replica answers its own datasets instead of forwarding them to the others
+    replicaRouting.ServeLocally();
     //GlobalRoutingHelper::CalculateRoutes();
 
-    Simulator::Stop(Seconds(1000));
+    profiler.Start("instrumentation");
+    if (!linkStatsFile.empty()) {
+        LlnlLinkStats::Get().Install(topologyReader, Seconds(linkBucket));
+    }
+
+    if (memInterval > 0) {
+        LlnlMemorySampler::Get().Start(Seconds(memInterval), memFile, memTopN);
+    }
+
+    profiler.Start("run");
+    Simulator::Stop(Seconds(stopTime));
 
     Simulator::Run();
+    profiler.Start("output");
+
+    if (memInterval > 0) {
+        LlnlMemorySampler::Get().PrintSummary(std::cout);
+        LlnlMemorySampler::Get().Stop();
+    }
+
+    if (!linkStatsFile.empty()) {
+        LlnlLinkStats::Get().PrintTop(std::cout, 10);
+        LlnlLinkStats::Get().Write(linkStatsFile);
+    }
+
+    if (app::LlnlWorkloadScaling::Get().IsScaled()) {
+        app::LlnlWorkloadScaling::Get().PrintReport(std::cout);
+    }
+
+    app::LlnlHeavyHitters::Get().Finish(Simulator::Now().GetNanoSeconds());
+
+    if (!completionFile.empty()) {
+        FinishDownloads();
+        if (!app::LlnlCompletionStats::Get().Write(completionFile)) {
+            std::cout << "Failed to write completion times to " << completionFile << std::endl;
+        }
+    }
+
+    if (!metricsFile.empty() && !app::LlnlRunMetrics::Get().Write(metricsFile)) {
+        std::cout << "Failed to write metrics to " << metricsFile << std::endl;
+    }
+
+    if (dynamicRouting != nullptr) {
+        dynamicRouting->PrintReport(std::cout);
+        if (!routingReport.empty() && !dynamicRouting->WriteReport(routingReport)) {
+            std::cout << "Failed to write the routing report to " << routingReport << std::endl;
+        }
+    }
+
+    if (!serverStats.empty()) {
+        ns3::ndn::SiteProducer::WriteStats(serverStats);
+    }
+    if (!admissionStats.empty()) {
+        LlnlTinyLfuContentStore::WriteStats(admissionStats);
+    }
+    app::LlnlInstrumentation::Dump(std::cout);
+
+    profiler.Start("destroy");
     Simulator::Destroy();
+    profiler.Stop();
+    profiler.Print(std::cout);
+    if (!profileFile.empty() && !profiler.Write(profileFile)) {
+        std::cout << "Failed to write the phase profile to " << profileFile << std::endl;
+    }
 
     return 0;
 }
@@ -27,6 +27,7 @@
 
 #include "closer-site-strategy.hpp"
 #include "fw/algorithm.hpp"
+#include "../llnl/llnl_instrumentation.hpp"
 
 #include <ndn-cxx/util/time.hpp>
 
@@ -216,6 +217,7 @@ void
 CloserSiteStrategy::afterReceiveInterest(const Face& inFace, const Interest& interest,
                                         const shared_ptr<pit::Entry>& pitEntry)
 {
+  app::LlnlInstrumentation::ScopedTimer timer(app::PROBE_STRATEGY_RECEIVE_INTEREST);
   // create timer information and attach to PIT entry
   auto pitEntryInfo = myGetOrCreateMyPitInfo(pitEntry);
   const fib::Entry& fibEntry = this->lookupFib(*pitEntry);
@@ -270,6 +272,7 @@ CloserSiteStrategy::beforeSatisfyInterest(const shared_ptr<pit::Entry>& pitEntry
                                           const Face& inFace,
                                           const Data& data)
 {
+  app::LlnlInstrumentation::ScopedTimer timer(app::PROBE_STRATEGY_SATISFY_INTEREST);
   NFD_LOG_TRACE("Received Data: " << data.getName() << " from Face id " << inFace.getId());
   auto pitInfo = pitEntry->getStrategyInfo<MyPitInfo>();
 
@@ -362,6 +365,8 @@ MyMeasurementInfo::updateFaceDelay(const Face& face, const milliseconds& delay)
 uint32_t
 MyMeasurementInfo::updateStoredNextHops(const fib::NextHopList& nexthops)
 {
+  app::LlnlInstrumentation::ScopedTimer timer(app::PROBE_STRATEGY_UPDATE_NEXTHOPS);
+  app::LlnlInstrumentation::Event(app::PROBE_STRATEGY_UPDATE_NEXTHOPS, nexthops.size());
   auto updatedFaceSet = new MyMeasurementInfo::WeightedFaceSet;
   auto& facesById = weightedFaces->get<MyMeasurementInfo::ByFaceId>();
   auto& updatedFacesById = updatedFaceSet->get<MyMeasurementInfo::ByFaceId>();
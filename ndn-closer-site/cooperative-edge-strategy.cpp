@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2016,  Regents of the University of California,
+ *                           Arizona Board of Regents,
+ *                           Colorado State University,
+ *                           University Pierre & Marie Curie, Sorbonne University,
+ *                           Washington University in St. Louis,
+ *                           Beijing Institute of Technology,
+ *                           The University of Memphis.
+ *
+ * Copyright (c) 2017 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of NFD (Named Data Networking Forwarding Daemon).
+ * See AUTHORS.md for complete list of NFD authors and contributors.
+ *
+ * NFD is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * NFD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * NFD, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cooperative-edge-strategy.hpp"
+#include "fw/algorithm.hpp"
+#include "../llnl/llnl_cooperative_cache.hpp"
+
+#include "ns3/simulator.h"
+
+NFD_LOG_INIT("CooperativeEdgeStrategy");
+namespace nfd {
+namespace fw {
+
+///////////////////////
+// PIT entry storage //
+///////////////////////
+
+// the detour an edge node sent this entry's Interest on
+class CooperativePitInfo : public StrategyInfo
+{
+public:
+  static int constexpr
+  getTypeId() { return 9974; }
+
+  FaceId detourFace = face::INVALID_FACEID;
+  uint32_t nonce = 0;
+};
+
+const Name CooperativeEdgeStrategy::STRATEGY_NAME("ndn:/localhost/nfd/strategy/cooperative-edge");
+
+CooperativeEdgeStrategy::CooperativeEdgeStrategy(Forwarder& forwarder, const Name& name)
+  : Strategy(forwarder, name)
+{
+}
+
+void
+CooperativeEdgeStrategy::afterReceiveInterest(const Face& inFace, const Interest& interest,
+                                              const shared_ptr<pit::Entry>& pitEntry)
+{
+  auto& coop = ns3::LlnlCooperativeCache::Get();
+  uint32_t node = ns3::Simulator::GetContext();
+
+  int64_t target = coop.GetDetour(interest);
+  if (target >= 0) {
+    Face* outFace = target != node ? this->getFace(coop.GetNextHop(node, target)) : nullptr;
+    if (outFace != nullptr && canForwardToLegacy(*pitEntry, *outFace)) {
+      this->sendInterest(pitEntry, *outFace, interest);
+    }
+    else if (!hasPendingOutRecords(*pitEntry)) {
+      // the neighbour's summary was stale or a false positive
+      NFD_LOG_DEBUG("Detour of " << interest.getName() << " to node " << target << " ends at " << node);
+      lp::NackHeader header;
+      header.setReason(lp::NackReason::NO_ROUTE);
+      this->sendNack(pitEntry, inFace, header);
+      this->rejectPendingInterest(pitEntry);
+    }
+    return;
+  }
+
+  // a local consumer's Interest that missed here, the first time it is forwarded
+  if (coop.IsEdge(node) && inFace.getScope() == ndn::nfd::FACE_SCOPE_LOCAL &&
+      !hasPendingOutRecords(*pitEntry)) {
+    int64_t holder = coop.FindHolder(node, interest.getName());
+    Face* outFace = holder >= 0 ? this->getFace(coop.GetNextHop(node, holder)) : nullptr;
+    if (outFace != nullptr && canForwardToLegacy(*pitEntry, *outFace)) {
+      NFD_LOG_TRACE("Detour of " << interest.getName() << " to node " << holder << " via face "
+                    << outFace->getId());
+      auto pitInfo = pitEntry->insertStrategyInfo<CooperativePitInfo>().first;
+      pitInfo->detourFace = outFace->getId();
+      pitInfo->nonce = interest.getNonce();
+      coop.SetDetour(interest, holder);
+      coop.GetStats(node).detours++;
+      this->sendInterest(pitEntry, *outFace, interest);
+      return;
+    }
+  }
+
+  forwardOnRoute(inFace, interest, pitEntry);
+}
+
+void
+CooperativeEdgeStrategy::forwardOnRoute(const Face& inFace, const Interest& interest,
+                                        const shared_ptr<pit::Entry>& pitEntry, FaceId nackedFace)
+{
+  const fib::Entry& fibEntry = this->lookupFib(*pitEntry);
+  for (const fib::NextHop& nexthop : fibEntry.getNextHops()) {
+    Face& outFace = nexthop.getFace();
+    // the detour may have gone out on the route's own face
+    bool canForward = outFace.getId() == nackedFace ? &outFace != &inFace
+                                                    : canForwardToLegacy(*pitEntry, outFace);
+    if (!wouldViolateScope(inFace, interest, outFace) && canForward) {
+      this->sendInterest(pitEntry, outFace, interest);
+      return;
+    }
+  }
+
+  if (!hasPendingOutRecords(*pitEntry)) {
+    this->rejectPendingInterest(pitEntry);
+  }
+}
+
+void
+CooperativeEdgeStrategy::beforeSatisfyInterest(const shared_ptr<pit::Entry>& pitEntry,
+                                               const Face& inFace,
+                                               const Data& data)
+{
+  auto pitInfo = pitEntry->getStrategyInfo<CooperativePitInfo>();
+  if (pitInfo == nullptr || pitInfo->detourFace == face::INVALID_FACEID) {
+    return;
+  }
+  auto& coop = ns3::LlnlCooperativeCache::Get();
+  if (inFace.getId() == pitInfo->detourFace) {
+    coop.GetStats(ns3::Simulator::GetContext()).hits++;
+  }
+  coop.ClearDetour(pitInfo->nonce, pitEntry->getName());
+  pitInfo->detourFace = face::INVALID_FACEID;
+}
+
+void
+CooperativeEdgeStrategy::afterReceiveNack(const Face& inFace, const lp::Nack& nack,
+                                          const shared_ptr<pit::Entry>& pitEntry)
+{
+  auto pitInfo = pitEntry->getStrategyInfo<CooperativePitInfo>();
+  if (pitInfo != nullptr && pitInfo->detourFace == inFace.getId() &&
+      pitEntry->in_begin() != pitEntry->in_end()) {
+    auto& coop = ns3::LlnlCooperativeCache::Get();
+    coop.GetStats(ns3::Simulator::GetContext()).nacks++;
+    coop.ClearDetour(pitInfo->nonce, pitEntry->getName());
+    pitInfo->detourFace = face::INVALID_FACEID;
+
+    // nodes on the detour remember the old nonce
+    Interest interest = pitEntry->getInterest();
+    interest.refreshNonce();
+    forwardOnRoute(pitEntry->in_begin()->getFace(), interest, pitEntry, inFace.getId());
+    return;
+  }
+
+  if (!hasPendingOutRecords(*pitEntry)) {
+    nackDownstream(pitEntry, nack.getHeader());
+  }
+}
+
+void
+CooperativeEdgeStrategy::beforeExpirePendingInterest(const shared_ptr<pit::Entry>& pitEntry)
+{
+  auto pitInfo = pitEntry->getStrategyInfo<CooperativePitInfo>();
+  if (pitInfo == nullptr || pitInfo->detourFace == face::INVALID_FACEID) {
+    return;
+  }
+  auto& coop = ns3::LlnlCooperativeCache::Get();
+  coop.GetStats(ns3::Simulator::GetContext()).timeouts++;
+  coop.ClearDetour(pitInfo->nonce, pitEntry->getName());
+  pitInfo->detourFace = face::INVALID_FACEID;
+}
+
+void
+CooperativeEdgeStrategy::nackDownstream(const shared_ptr<pit::Entry>& pitEntry, const lp::NackHeader& header)
+{
+  // sendNack deletes the in-record
+  std::vector<Face*> downstreams;
+  for (auto it = pitEntry->in_begin(); it != pitEntry->in_end(); ++it) {
+    downstreams.push_back(&it->getFace());
+  }
+  for (Face* face : downstreams) {
+    this->sendNack(pitEntry, *face, header);
+  }
+  this->rejectPendingInterest(pitEntry);
+}
+
+} // namespace fw
+} // namespace nfd
@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2016,  Regents of the University of California,
+ *                           Arizona Board of Regents,
+ *                           Colorado State University,
+ *                           University Pierre & Marie Curie, Sorbonne University,
+ *                           Washington University in St. Louis,
+ *                           Beijing Institute of Technology,
+ *                           The University of Memphis.
+ *
+ * Copyright (c) 2017 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of NFD (Named Data Networking Forwarding Daemon).
+ * See AUTHORS.md for complete list of NFD authors and contributors.
+ *
+ * NFD is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * NFD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * NFD, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NFD_DAEMON_FW_COOPERATIVE_EDGE_STRATEGY_HPP
+#define NFD_DAEMON_FW_COOPERATIVE_EDGE_STRATEGY_HPP
+
+#include "fw/strategy.hpp"
+
+namespace nfd {
+namespace fw {
+
+/** \brief best-route forwarding that first tries a neighbour edge cache
+ *
+ * On an edge node, an Interest from a local consumer that missed the content
+ * store is sent toward the nearest neighbour edge node whose cache summary (see
+ * ns3::LlnlCooperativeCache) has its name, if one is within the delay budget.
+ * Nodes on the way forward it toward that neighbour; if the neighbour misses too
+ * it returns a Nack, and the edge node sends the Interest on the normal route
+ * with a new nonce. All other Interests take the lowest-cost nexthop.
+ */
+class CooperativeEdgeStrategy : public Strategy
+{
+public:
+  CooperativeEdgeStrategy(Forwarder& forwarder, const Name& name = STRATEGY_NAME);
+
+  virtual void
+  afterReceiveInterest(const Face& inFace, const Interest& interest,
+                       const shared_ptr<pit::Entry>& pitEntry) override;
+
+  virtual void
+  beforeSatisfyInterest(const shared_ptr<pit::Entry>& pitEntry,
+                        const Face& inFace,
+                        const Data& data) override;
+
+  virtual void
+  afterReceiveNack(const Face& inFace, const lp::Nack& nack,
+                   const shared_ptr<pit::Entry>& pitEntry) override;
+
+  virtual void
+  beforeExpirePendingInterest(const shared_ptr<pit::Entry>& pitEntry) override;
+
+private:
+  void
+  forwardOnRoute(const Face& inFace, const Interest& interest, const shared_ptr<pit::Entry>& pitEntry,
+                 FaceId nackedFace = face::INVALID_FACEID);
+
+  void
+  nackDownstream(const shared_ptr<pit::Entry>& pitEntry, const lp::NackHeader& header);
+
+public:
+  static const Name STRATEGY_NAME;
+};
+
+} // namespace fw
+} // namespace nfd
+
+#endif // NFD_DAEMON_FW_COOPERATIVE_EDGE_STRATEGY_HPP
@@ -0,0 +1,450 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ * Copyright (c) 2017 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "dynamic-routing-helper.hpp"
+
+#include "ns3/log.h"
+#include "ns3/names.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/simulator.h"
+
+#include "model/ndn-l3-protocol.hpp"
+#include "helper/ndn-fib-helper.hpp"
+#include "helper/ndn-link-control-helper.hpp"
+#include "NFD/daemon/fw/forwarder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE("ndn.DynamicRoutingHelper");
+
+namespace ns3 {
+namespace ndn {
+
+namespace {
+
+const uint64_t UNREACHABLE = RoutingGraph::UNREACHABLE;
+
+} // namespace
+
+DynamicRoutingHelper::DynamicRoutingHelper(uint32_t k)
+  : m_k(k)
+  , m_window(Seconds(10))
+{
+}
+
+void
+DynamicRoutingHelper::ReadGraph()
+{
+  m_graph.Read();
+  uint32_t n = m_graph.out.size();
+  m_announced.assign(n, std::vector<std::string>());
+  m_mark.assign(n, 0);
+  m_prefixes.clear();
+  for (const auto& origins : m_graph.origins) {
+    m_prefixes.push_back(Prefix());
+    m_prefixes.back().name = origins.first;
+    for (uint32_t v : origins.second) {
+      m_prefixes.back().origins.insert(v);
+      m_announced[v].push_back(origins.first.toUri());
+    }
+  }
+}
+
+DynamicRoutingHelper::Stats
+DynamicRoutingHelper::CalculateRoutes()
+{
+  ReadGraph();
+  Stats stats;
+  uint32_t n = m_graph.out.size();
+  std::vector<uint32_t> changed;
+  for (Prefix& prefix : m_prefixes) {
+    prefix.distance.assign(n, UNREACHABLE);
+    prefix.parent.assign(n, -1);
+    Queue queue;
+    for (uint32_t origin : prefix.origins) {
+      prefix.distance[origin] = 0;
+      queue.push_back(std::make_pair(0, origin));
+    }
+    std::make_heap(queue.begin(), queue.end(), std::greater<Queue::value_type>());
+    changed.clear();
+    m_graph.Propagate(prefix.distance, prefix.parent, queue, changed);
+
+    for (uint32_t v = 0; v < n; v++) {
+      Ptr<Node> node = NodeList::GetNode(v);
+      for (const auto& hop : NextHops(prefix, v)) {
+        FibHelper::AddRoute(node, prefix.name, m_graph.out[v][hop.second].face, static_cast<int32_t>(hop.first));
+        stats.routes++;
+      }
+    }
+    stats.prefixes++;
+  }
+  return stats;
+}
+
+// resets every node whose path goes through one of the roots, and reaches them
+// again from their neighbours outside that set
+void
+DynamicRoutingHelper::RemoveSubtrees(Prefix& prefix, const std::vector<uint32_t>& roots,
+                                     std::vector<uint32_t>& changed)
+{
+  size_t first = changed.size();
+  for (uint32_t root : roots) {
+    if (m_mark[root]) {
+      continue;
+    }
+    m_mark[root] = 1;
+    changed.push_back(root);
+  }
+  for (size_t i = first; i < changed.size(); i++) {
+    for (const auto& link : m_graph.in[changed[i]]) {
+      if (!m_mark[link.first] && prefix.parent[link.first] == changed[i]) {
+        m_mark[link.first] = 1;
+        changed.push_back(link.first);
+      }
+    }
+  }
+  for (size_t i = first; i < changed.size(); i++) {
+    prefix.distance[changed[i]] = UNREACHABLE;
+    prefix.parent[changed[i]] = -1;
+  }
+
+  Queue queue;
+  for (size_t i = first; i < changed.size(); i++) {
+    uint32_t v = changed[i];
+    if (prefix.origins.count(v) > 0) {
+      prefix.distance[v] = 0;
+    }
+    else {
+      for (const Edge& edge : m_graph.out[v]) {
+        uint64_t d = prefix.distance[edge.neighbour];
+        if (edge.up && !m_mark[edge.neighbour] && d != UNREACHABLE && d + edge.metric < prefix.distance[v]) {
+          prefix.distance[v] = d + edge.metric;
+          prefix.parent[v] = edge.neighbour;
+        }
+      }
+    }
+    if (prefix.distance[v] != UNREACHABLE) {
+      queue.push_back(std::make_pair(prefix.distance[v], v));
+    }
+  }
+  for (size_t i = first; i < changed.size(); i++) {
+    m_mark[changed[i]] = 0;
+  }
+  std::make_heap(queue.begin(), queue.end(), std::greater<Queue::value_type>());
+  m_graph.Propagate(prefix.distance, prefix.parent, queue, changed);
+}
+
+// (cost, index in m_graph.out[node]) of the faces the node forwards the prefix on
+std::vector<std::pair<uint64_t, size_t>>
+DynamicRoutingHelper::NextHops(const Prefix& prefix, uint32_t node) const
+{
+  std::vector<std::pair<uint64_t, size_t>> ranked;
+  m_graph.RankNextHops(prefix.distance, node, m_k, ranked);
+  ranked.resize(m_k > 0 ? std::min<size_t>(m_k, ranked.size()) : ranked.size());
+  return ranked;
+}
+
+// brings the FIB entries of the changed nodes and the nodes linked to them in line
+// with the distances; faces that are not links, e.g. the producers', are left alone
+void
+DynamicRoutingHelper::UpdateFib(const Prefix& prefix, const std::vector<uint32_t>& changed,
+                                EventReport& report)
+{
+  std::vector<uint32_t> touched;
+  for (uint32_t v : changed) {
+    if (!m_mark[v]) {
+      m_mark[v] = 1;
+      touched.push_back(v);
+      report.nodesChanged++;
+    }
+  }
+  for (size_t i = 0, n = touched.size(); i < n; i++) {
+    for (const auto& link : m_graph.in[touched[i]]) {
+      if (!m_mark[link.first]) {
+        m_mark[link.first] = 1;
+        touched.push_back(link.first);
+      }
+    }
+  }
+
+  for (uint32_t v : touched) {
+    m_mark[v] = 0;
+    Ptr<Node> node = NodeList::GetNode(v);
+    std::map<FaceId, uint64_t> installed;
+    Ptr<L3Protocol> l3 = node->GetObject<L3Protocol>();
+    const nfd::fib::Entry* entry = l3->getForwarder()->getFib().findExactMatch(prefix.name);
+    if (entry != nullptr) {
+      for (const nfd::fib::NextHop& nexthop : entry->getNextHops()) {
+        installed[nexthop.getFace().getId()] = nexthop.getCost();
+      }
+    }
+
+    std::vector<uint64_t> cost(m_graph.out[v].size(), UNREACHABLE);
+    for (const auto& hop : NextHops(prefix, v)) {
+      cost[hop.second] = hop.first;
+    }
+    for (size_t e = 0; e < m_graph.out[v].size(); e++) {
+      const Edge& edge = m_graph.out[v][e];
+      auto current = installed.find(edge.face->getId());
+      if (cost[e] == UNREACHABLE) {
+        if (current != installed.end()) {
+          FibHelper::RemoveRoute(node, prefix.name, edge.face);
+          report.routesRemoved++;
+        }
+      }
+      else if (current == installed.end() || current->second != cost[e]) {
+        NS_LOG_DEBUG("Node " << v << " " << prefix.name << " via node " << edge.neighbour
+                     << " cost " << cost[e]);
+        FibHelper::AddRoute(node, prefix.name, edge.face, static_cast<int32_t>(cost[e]));
+        (current == installed.end() ? report.routesAdded : report.routesUpdated)++;
+      }
+    }
+  }
+  report.nodesTouched += touched.size();
+}
+
+bool
+DynamicRoutingHelper::ScheduleEvents(const std::string& fileName)
+{
+  std::ifstream is(fileName);
+  if (!is) {
+    std::cout << "Failed to open routing events " << fileName << std::endl;
+    return false;
+  }
+
+  static const std::map<std::string, EventType> TYPES = {
+    {"link-down", LINK_DOWN}, {"link-up", LINK_UP}, {"withdraw", WITHDRAW}, {"announce", ANNOUNCE}
+  };
+  std::string line;
+  while (std::getline(is, line)) {
+    std::istringstream ss(line);
+    Event event;
+    std::string type, a, b;
+    if (!(ss >> event.time)) {
+      continue; // comments and blank lines
+    }
+    ss >> type >> a >> b;
+    auto t = TYPES.find(type);
+    Ptr<Node> nodeA = Names::Find<Node>(a);
+    Ptr<Node> nodeB = b.empty() ? nullptr : Names::Find<Node>(b);
+    bool isLink = t != TYPES.end() && (t->second == LINK_DOWN || t->second == LINK_UP);
+    if (t == TYPES.end() || nodeA == nullptr || (isLink && nodeB == nullptr)) {
+      std::cout << "Skipping routing event: " << line << std::endl;
+      continue;
+    }
+    if (isLink && !m_graph.IsLinked(nodeA->GetId(), nodeB->GetId())) {
+      std::cout << "Routing event on nodes " << a << " and " << b << " that are not linked: "
+                << line << std::endl;
+      return false;
+    }
+    event.type = t->second;
+    event.a = nodeA->GetId();
+    event.b = isLink ? nodeB->GetId() : 0;
+    event.prefix = isLink ? "" : b;
+    event.text = type + " " + a + (b.empty() ? "" : " " + b);
+    m_events.push_back(event);
+  }
+
+  m_reports.assign(m_events.size(), EventReport());
+  m_lossAtEvent.assign(m_events.size(), 0);
+  for (size_t i = 0; i < m_events.size(); i++) {
+    Time at = Seconds(m_events[i].time);
+    m_reports[i].time = m_events[i].time;
+    m_reports[i].event = m_events[i].text;
+    if (m_losses) {
+      Simulator::Schedule(std::max(at - m_window, Seconds(0)), &DynamicRoutingHelper::SampleLosses, this, i, false);
+      Simulator::Schedule(at + m_window, &DynamicRoutingHelper::SampleLosses, this, i, true);
+    }
+    Simulator::Schedule(at, &DynamicRoutingHelper::Apply, this, i);
+  }
+  std::cout << "Routing events: " << m_events.size() << " scheduled from " << fileName << std::endl;
+  return true;
+}
+
+void
+DynamicRoutingHelper::SetImpactCounters(Counter inFlight, Counter losses, Time window)
+{
+  m_inFlight = inFlight;
+  m_losses = losses;
+  m_window = window;
+}
+
+// called before the event with after = false, and again once the window has passed
+void
+DynamicRoutingHelper::SampleLosses(size_t index, bool after)
+{
+  if (after) {
+    m_reports[index].lossAfter = m_losses() - m_lossAtEvent[index];
+  }
+  else {
+    m_reports[index].lossBefore = m_losses();
+  }
+}
+
+void
+DynamicRoutingHelper::Apply(size_t index)
+{
+  const Event& event = m_events[index];
+  EventReport& report = m_reports[index];
+  if (m_inFlight) {
+    report.inFlight = m_inFlight();
+  }
+  if (m_losses) {
+    m_lossAtEvent[index] = m_losses();
+    report.lossBefore = m_lossAtEvent[index] - report.lossBefore;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  if (event.type == LINK_DOWN || event.type == LINK_UP) {
+    bool up = event.type == LINK_UP;
+    for (auto ends : {std::make_pair(event.a, event.b), std::make_pair(event.b, event.a)}) {
+      for (Edge& edge : m_graph.out[ends.first]) {
+        if (edge.neighbour == ends.second) {
+          edge.up = up;
+        }
+      }
+    }
+    if (up) {
+      LinkControlHelper::UpLink(NodeList::GetNode(event.a), NodeList::GetNode(event.b));
+    }
+    else {
+      LinkControlHelper::FailLink(NodeList::GetNode(event.a), NodeList::GetNode(event.b));
+    }
+  }
+
+  std::vector<uint32_t> changed;
+  for (Prefix& prefix : m_prefixes) {
+    changed.clear();
+    switch (event.type) {
+    case LINK_DOWN: {
+      std::vector<uint32_t> roots;
+      if (prefix.parent[event.a] == event.b) {
+        roots.push_back(event.a);
+      }
+      if (prefix.parent[event.b] == event.a) {
+        roots.push_back(event.b);
+      }
+      if (!roots.empty()) {
+        RemoveSubtrees(prefix, roots, changed);
+      }
+      // the ends may have had the link among their other next hops
+      changed.push_back(event.a);
+      changed.push_back(event.b);
+      break;
+    }
+    case LINK_UP: {
+      Queue queue;
+      for (auto ends : {std::make_pair(event.a, event.b), std::make_pair(event.b, event.a)}) {
+        uint64_t d = prefix.distance[ends.second];
+        for (const Edge& edge : m_graph.out[ends.first]) {
+          if (edge.neighbour == ends.second && d != UNREACHABLE && d + edge.metric < prefix.distance[ends.first]) {
+            prefix.distance[ends.first] = d + edge.metric;
+            prefix.parent[ends.first] = ends.second;
+            queue.push_back(std::make_pair(prefix.distance[ends.first], ends.first));
+          }
+        }
+      }
+      std::make_heap(queue.begin(), queue.end(), std::greater<Queue::value_type>());
+      m_graph.Propagate(prefix.distance, prefix.parent, queue, changed);
+      changed.push_back(event.a);
+      changed.push_back(event.b);
+      break;
+    }
+    case WITHDRAW: {
+      if ((!event.prefix.empty() && prefix.name != Name(event.prefix)) ||
+          prefix.origins.erase(event.a) == 0) {
+        continue;
+      }
+      RemoveSubtrees(prefix, std::vector<uint32_t>{event.a}, changed);
+      break;
+    }
+    case ANNOUNCE: {
+      if (prefix.origins.count(event.a) > 0) {
+        continue;
+      }
+      if (event.prefix.empty() ? std::find(m_announced[event.a].begin(), m_announced[event.a].end(),
+                                           prefix.name.toUri()) == m_announced[event.a].end()
+                               : prefix.name != Name(event.prefix)) {
+        continue;
+      }
+      prefix.origins.insert(event.a);
+      prefix.distance[event.a] = 0;
+      prefix.parent[event.a] = -1;
+      changed.push_back(event.a);
+      Queue queue(1, Queue::value_type(0, event.a));
+      m_graph.Propagate(prefix.distance, prefix.parent, queue, changed);
+      break;
+    }
+    }
+    UpdateFib(prefix, changed, report);
+  }
+  report.wallUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+  NS_LOG_INFO(event.text << ": " << report.nodesChanged << " nodes changed, " << report.routesAdded
+              << " routes added, " << report.routesRemoved << " removed, " << report.routesUpdated
+              << " updated in " << report.wallUs << " us");
+}
+
+void
+DynamicRoutingHelper::PrintReport(std::ostream& os) const
+{
+  if (m_reports.empty()) {
+    return;
+  }
+  os << "Routing events (timeouts and Nacks in the " << m_window.GetSeconds() << " s before and after)"
+     << std::endl;
+  os << std::left << std::setw(10) << "time" << std::setw(32) << "event" << std::right << std::setw(10)
+     << "wall us" << std::setw(9) << "changed" << std::setw(9) << "touched" << std::setw(8) << "added"
+     << std::setw(8) << "removed" << std::setw(8) << "updated" << std::setw(10) << "in flight"
+     << std::setw(8) << "before" << std::setw(8) << "after" << std::endl;
+  for (const EventReport& r : m_reports) {
+    os << std::left << std::setw(10) << r.time << std::setw(32) << r.event << std::right << std::setw(10)
+       << std::fixed << std::setprecision(0) << r.wallUs << std::defaultfloat << std::setw(9)
+       << r.nodesChanged << std::setw(9) << r.nodesTouched << std::setw(8) << r.routesAdded << std::setw(8)
+       << r.routesRemoved << std::setw(8) << r.routesUpdated << std::setw(10) << r.inFlight << std::setw(8)
+       << r.lossBefore << std::setw(8) << r.lossAfter << std::endl;
+  }
+}
+
+bool
+DynamicRoutingHelper::WriteReport(const std::string& fileName) const
+{
+  std::ofstream os(fileName);
+  if (!os) {
+    return false;
+  }
+  os << "time\tevent\twall_us\tnodes_changed\tnodes_touched\troutes_added\troutes_removed"
+     << "\troutes_updated\tin_flight\tloss_before\tloss_after\n";
+  for (const EventReport& r : m_reports) {
+    os << r.time << "\t" << r.event << "\t" << r.wallUs << "\t" << r.nodesChanged << "\t" << r.nodesTouched
+       << "\t" << r.routesAdded << "\t" << r.routesRemoved << "\t" << r.routesUpdated << "\t" << r.inFlight
+       << "\t" << r.lossBefore << "\t" << r.lossAfter << "\n";
+  }
+  return static_cast<bool>(os);
+}
+
+} // namespace ndn
+} // namespace ns3
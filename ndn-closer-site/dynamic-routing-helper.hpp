@@ -0,0 +1,182 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ * Copyright (c) 2017 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_CLOSER_SITE_DYNAMIC_ROUTING_HELPER_HPP
+#define NDN_CLOSER_SITE_DYNAMIC_ROUTING_HELPER_HPP
+
+#include "routing-graph.hpp"
+
+#include "ns3/ndnSIM/model/ndn-common.hpp"
+#include "ns3/nstime.h"
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/** \brief routes that follow scheduled link and producer events during the run
+ *
+ * Keeps, for every prefix announced with GlobalRoutingHelper::AddOrigins, each
+ * node's distance to the nearest origin and the neighbour it goes through, which
+ * KBestRoutingHelper does not keep. Both compute distances and rank next hops with
+ * RoutingGraph: next hops are the K cheapest faces (all of them for K = 0) toward
+ * neighbours closer to an origin, by metric plus the neighbour's distance.
+ *
+ * Events are read from a file of lines
+ *
+ *   <seconds> link-down <node> <node>
+ *   <seconds> link-up <node> <node>
+ *   <seconds> withdraw <node> [<prefix>]
+ *   <seconds> announce <node> [<prefix>]
+ *
+ * (without a prefix, every prefix the node originated at the start). The nodes of a
+ * link event must be linked to each other, or the file is rejected. A link or an
+ * origin that goes away invalidates only the nodes whose path used it: they are
+ * reset and re-reached from their unaffected neighbours. One that comes back only
+ * spreads the distances it improves. Only the nodes whose distance or path changed,
+ * and the nodes next to them, have their FIB entries compared and updated.
+ *
+ * For every event the wall time, the nodes changed and the routes added, removed or
+ * updated are reported, with the Interests in flight at the event and the timeouts
+ * and Nacks in the window before and after it.
+ */
+class DynamicRoutingHelper
+{
+public:
+  typedef std::function<uint64_t()> Counter;
+
+  struct Stats
+  {
+    uint32_t prefixes = 0;
+    uint64_t routes = 0;
+  };
+
+  struct EventReport
+  {
+    double time = 0;
+    std::string event;
+    double wallUs = 0;
+    uint32_t nodesChanged = 0; // distance or path to an origin
+    uint32_t nodesTouched = 0; // FIB entries compared
+    uint64_t routesAdded = 0;
+    uint64_t routesRemoved = 0;
+    uint64_t routesUpdated = 0;
+    uint64_t inFlight = 0;
+    uint64_t lossBefore = 0; // timeouts and Nacks in the window before the event
+    uint64_t lossAfter = 0;
+  };
+
+  /** \param k next hops per prefix per node, 0 for every usable face
+   */
+  explicit
+  DynamicRoutingHelper(uint32_t k = 0);
+
+  /** \brief read the graph and origins, calculate and install the routes of all prefixes
+   */
+  Stats
+  CalculateRoutes();
+
+  /** \brief schedule the events of the file, after CalculateRoutes()
+   */
+  bool
+  ScheduleEvents(const std::string& fileName);
+
+  /** \brief counters sampled around each event to measure its effect on downloads
+   */
+  void
+  SetImpactCounters(Counter inFlight, Counter losses, Time window);
+
+  void
+  PrintReport(std::ostream& os) const;
+
+  bool
+  WriteReport(const std::string& fileName) const;
+
+private:
+  typedef RoutingGraph::Edge Edge;
+  typedef RoutingGraph::Queue Queue;
+
+  struct Prefix
+  {
+    Name name;
+    std::set<uint32_t> origins;
+    std::vector<uint64_t> distance;
+    std::vector<int64_t> parent; // next node toward the nearest origin, -1 at origins
+  };
+
+  enum EventType {
+    LINK_DOWN,
+    LINK_UP,
+    WITHDRAW,
+    ANNOUNCE
+  };
+
+  struct Event
+  {
+    double time;
+    EventType type;
+    uint32_t a;
+    uint32_t b;
+    std::string prefix; // empty for all of the node's prefixes
+    std::string text;
+  };
+
+  void
+  ReadGraph();
+
+  void
+  RemoveSubtrees(Prefix& prefix, const std::vector<uint32_t>& roots, std::vector<uint32_t>& changed);
+
+  void
+  UpdateFib(const Prefix& prefix, const std::vector<uint32_t>& changed, EventReport& report);
+
+  std::vector<std::pair<uint64_t, size_t>>
+  NextHops(const Prefix& prefix, uint32_t node) const;
+
+  void
+  Apply(size_t index);
+
+  void
+  SampleLosses(size_t index, bool after);
+
+private:
+  uint32_t m_k;
+  RoutingGraph m_graph;
+  std::vector<Prefix> m_prefixes;
+  std::vector<std::vector<std::string>> m_announced; // prefixes of each node at the start
+  std::vector<uint8_t> m_mark;
+
+  std::vector<Event> m_events;
+  std::vector<EventReport> m_reports;
+  std::vector<uint64_t> m_lossAtEvent;
+  Counter m_inFlight;
+  Counter m_losses;
+  Time m_window;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_CLOSER_SITE_DYNAMIC_ROUTING_HELPER_HPP
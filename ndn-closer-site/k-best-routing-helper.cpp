@@ -0,0 +1,83 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ * Copyright (c) 2017 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "k-best-routing-helper.hpp"
+
+#include "routing-graph.hpp"
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+
+#include "helper/ndn-fib-helper.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+NS_LOG_COMPONENT_DEFINE("ndn.KBestRoutingHelper");
+
+namespace ns3 {
+namespace ndn {
+
+KBestRoutingHelper::Stats
+KBestRoutingHelper::CalculateRoutes(uint32_t k)
+{
+  NS_ASSERT(k >= 1);
+  Stats stats;
+
+  RoutingGraph graph;
+  graph.Read();
+  uint32_t n = graph.out.size();
+  std::vector<uint64_t> distance(n);
+  std::vector<int64_t> parent(n);
+  std::vector<uint32_t> changed;
+  std::vector<std::pair<uint64_t, size_t>> ranked;
+  for (const auto& prefix : graph.origins) {
+    std::fill(distance.begin(), distance.end(), RoutingGraph::UNREACHABLE);
+    RoutingGraph::Queue queue;
+    for (uint32_t origin : prefix.second) {
+      distance[origin] = 0;
+      queue.push_back(std::make_pair(0, origin));
+    }
+    std::make_heap(queue.begin(), queue.end(), std::greater<RoutingGraph::Queue::value_type>());
+    changed.clear();
+    graph.Propagate(distance, parent, queue, changed);
+
+    for (uint32_t v = 0; v < n; v++) {
+      graph.RankNextHops(distance, v, k, ranked);
+      stats.maxNextHops = std::max<uint32_t>(stats.maxNextHops, ranked.size());
+      size_t keep = std::min<size_t>(k, ranked.size());
+      Ptr<Node> node = NodeList::GetNode(v);
+      for (size_t i = 0; i < keep; i++) {
+        const RoutingGraph::Edge& edge = graph.out[v][ranked[i].second];
+        NS_LOG_DEBUG("Node " << v << " " << prefix.first << " via node " << edge.neighbour
+                     << " cost " << ranked[i].first);
+        FibHelper::AddRoute(node, prefix.first, edge.face, static_cast<int32_t>(ranked[i].first));
+        stats.routes++;
+      }
+    }
+    stats.prefixes++;
+  }
+  return stats;
+}
+
+} // namespace ndn
+} // namespace ns3
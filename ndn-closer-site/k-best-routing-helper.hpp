@@ -0,0 +1,62 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ * Copyright (c) 2017 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_CLOSER_SITE_K_BEST_ROUTING_HELPER_HPP
+#define NDN_CLOSER_SITE_K_BEST_ROUTING_HELPER_HPP
+
+#include "ns3/ndnSIM/model/ndn-common.hpp"
+
+#include <cstdint>
+
+namespace ns3 {
+namespace ndn {
+
+/** \brief route calculation with at most K next hops per prefix per node
+ *
+ * A bounded alternative to GlobalRoutingHelper::CalculateAllPossibleRoutes. For
+ * every prefix announced with GlobalRoutingHelper::AddOrigins one multi-source
+ * Dijkstra from all its origins gives each node's distance to the nearest origin.
+ * A face of a node that leads to a neighbour closer to an origin is then worth its
+ * metric plus that neighbour's distance, and the K cheapest such faces become the
+ * node's next hops, with that cost as the route metric. Faces toward neighbours at
+ * the same or a larger distance are left out, as their path may come back through
+ * the node. This is one Dijkstra per prefix instead of one per face,
+ * and keeps the next hop lists of high-degree nodes short.
+ */
+class KBestRoutingHelper
+{
+public:
+  struct Stats
+  {
+    uint32_t prefixes = 0;
+    uint64_t routes = 0;
+    uint32_t maxNextHops = 0; // largest next hop list that could have been installed
+  };
+
+  /** \brief calculate and install the routes of all prefixes, k >= 1
+   */
+  static Stats
+  CalculateRoutes(uint32_t k);
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_CLOSER_SITE_K_BEST_ROUTING_HELPER_HPP
@@ -0,0 +1,263 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2016,  Regents of the University of California,
+ *                           Arizona Board of Regents,
+ *                           Colorado State University,
+ *                           University Pierre & Marie Curie, Sorbonne University,
+ *                           Washington University in St. Louis,
+ *                           Beijing Institute of Technology,
+ *                           The University of Memphis.
+ *
+ * Copyright (c) 2017 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of NFD (Named Data Networking Forwarding Daemon).
+ * See AUTHORS.md for complete list of NFD authors and contributors.
+ *
+ * NFD is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * NFD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * NFD, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "load-aware-site-strategy.hpp"
+#include "fw/algorithm.hpp"
+
+#include "ns3/random-variable-stream.h"
+
+#include <ndn-cxx/util/time.hpp>
+
+#include <algorithm>
+#include <limits>
+
+NFD_LOG_INIT("LoadAwareSiteStrategy");
+namespace nfd {
+namespace fw {
+
+///////////////////////
+// PIT entry storage //
+///////////////////////
+
+// faces this entry's Interest was counted against
+class LoadAwarePitInfo : public StrategyInfo
+{
+public:
+  static int constexpr
+  getTypeId() { return 9972; }
+
+  std::vector<FaceId> counted;
+};
+
+///////////////////////////////
+// Measurement entry storage //
+///////////////////////////////
+
+class LoadAwareMeasurementInfo : public StrategyInfo
+{
+public:
+  static int constexpr
+  getTypeId() { return 9973; }
+
+  // smoothed delay in ms, as TCP's SRTT
+  void
+  updateDelay(FaceId face, double delay)
+  {
+    auto it = srtt.find(face);
+    if (it == srtt.end()) {
+      srtt[face] = delay;
+    }
+    else {
+      it->second += 0.125 * (delay - it->second);
+    }
+  }
+
+  // negative if not measured yet
+  double
+  getDelay(FaceId face) const
+  {
+    auto it = srtt.find(face);
+    return it != srtt.end() ? it->second : -1;
+  }
+
+  std::unordered_map<FaceId, double> srtt;
+};
+
+const Name LoadAwareSiteStrategy::STRATEGY_NAME("ndn:/localhost/nfd/strategy/load-aware-site");
+
+LoadAwareSiteStrategy::LoadAwareSiteStrategy(Forwarder& forwarder, const Name& name)
+  : Strategy(forwarder, name)
+  , m_params(getParameters())
+{
+  // a stream of the run's ns-3 RNG, so RngSeed and RngRun vary the choices
+  ns3::Ptr<ns3::UniformRandomVariable> seed = ns3::CreateObject<ns3::UniformRandomVariable>();
+  m_rng.seed(seed->GetInteger(0, std::numeric_limits<uint32_t>::max()));
+}
+
+LoadAwareSiteStrategy::Parameters&
+LoadAwareSiteStrategy::getParameters()
+{
+  static Parameters params;
+  return params;
+}
+
+uint32_t
+LoadAwareSiteStrategy::getOutstanding(FaceId face) const
+{
+  auto it = m_outstanding.find(face);
+  return it != m_outstanding.end() ? it->second : 0;
+}
+
+double
+LoadAwareSiteStrategy::score(Face& face, const LoadAwareMeasurementInfo& info) const
+{
+  return info.getDelay(face.getId()) + getOutstanding(face.getId()) * m_params.loadPenalty.count();
+}
+
+Face*
+LoadAwareSiteStrategy::selectFace(const std::vector<Face*>& candidates, const LoadAwareMeasurementInfo& info)
+{
+  double best = -1;
+  for (Face* face : candidates) {
+    double delay = info.getDelay(face->getId());
+    if (delay >= 0 && (best < 0 || delay < best)) {
+      best = delay;
+    }
+  }
+  if (best < 0) {
+    return nullptr;
+  }
+
+  std::vector<Face*> eligible;
+  for (Face* face : candidates) {
+    double delay = info.getDelay(face->getId());
+    if (delay >= 0 && delay <= best + m_params.tolerance.count()) {
+      eligible.push_back(face);
+    }
+  }
+  if (eligible.size() == 1) {
+    return eligible.front();
+  }
+
+  if (m_params.selection == POWER_OF_TWO) {
+    std::uniform_int_distribution<size_t> pick(0, eligible.size() - 1);
+    Face* a = eligible[pick(m_rng)];
+    Face* b = a;
+    while (b == a) {
+      b = eligible[pick(m_rng)];
+    }
+    return score(*a, info) <= score(*b, info) ? a : b;
+  }
+
+  std::vector<double> weights;
+  for (Face* face : eligible) {
+    weights.push_back(1.0 / (1.0 + score(*face, info)));
+  }
+  std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+  return eligible[pick(m_rng)];
+}
+
+void
+LoadAwareSiteStrategy::afterReceiveInterest(const Face& inFace, const Interest& interest,
+                                            const shared_ptr<pit::Entry>& pitEntry)
+{
+  const fib::Entry& fibEntry = this->lookupFib(*pitEntry);
+  const fib::NextHopList& nexthops = fibEntry.getNextHops();
+
+  auto measurementsEntry = getMeasurements().get(fibEntry);
+  BOOST_ASSERT(measurementsEntry != nullptr);
+  auto info = measurementsEntry->insertStrategyInfo<LoadAwareMeasurementInfo>().first;
+  auto pitInfo = pitEntry->insertStrategyInfo<LoadAwarePitInfo>().first;
+
+  std::vector<Face*> candidates;
+  for (fib::NextHopList::const_iterator it = nexthops.begin(); it != nexthops.end(); ++it) {
+    Face& outFace = it->getFace();
+    if (!wouldViolateScope(inFace, interest, outFace) &&
+        canForwardToLegacy(*pitEntry, outFace)) {
+      candidates.push_back(&outFace);
+    }
+  }
+
+  Face* chosen = selectFace(candidates, *info);
+  for (Face* outFace : candidates) {
+    if (chosen != nullptr && outFace != chosen) {
+      continue;
+    }
+    NFD_LOG_TRACE("outFace id " << outFace->getId() << " outstanding " << getOutstanding(outFace->getId()));
+    this->sendInterest(pitEntry, *outFace, interest);
+    if (std::find(pitInfo->counted.begin(), pitInfo->counted.end(), outFace->getId()) == pitInfo->counted.end()) {
+      pitInfo->counted.push_back(outFace->getId());
+      m_outstanding[outFace->getId()]++;
+    }
+  }
+
+  if (!hasPendingOutRecords(*pitEntry)) {
+    this->rejectPendingInterest(pitEntry);
+  }
+}
+
+void
+LoadAwareSiteStrategy::beforeSatisfyInterest(const shared_ptr<pit::Entry>& pitEntry,
+                                             const Face& inFace,
+                                             const Data& data)
+{
+  auto outRecord = pitEntry->getOutRecord(inFace);
+  if (outRecord != pitEntry->out_end()) {
+    double delay = time::duration_cast<time::microseconds>(time::steady_clock::now() -
+                                                           outRecord->getLastRenewed()).count() / 1000.0;
+    NFD_LOG_TRACE("Face Id " << inFace.getId() << " delay " << delay << "ms");
+
+    // update the delay on every measurements entry up to the FIB prefix
+    auto& accessor = getMeasurements();
+    for (auto entry = accessor.get(*pitEntry); entry != nullptr; entry = accessor.getParent(*entry)) {
+      auto info = entry->getStrategyInfo<LoadAwareMeasurementInfo>();
+      if (info != nullptr) {
+        accessor.extendLifetime(*entry, time::seconds(16));
+        info->updateDelay(inFace.getId(), delay);
+      }
+    }
+  }
+
+  releaseAll(pitEntry);
+}
+
+void
+LoadAwareSiteStrategy::afterReceiveNack(const Face& inFace, const lp::Nack& nack,
+                                        const shared_ptr<pit::Entry>& pitEntry)
+{
+  auto pitInfo = pitEntry->getStrategyInfo<LoadAwarePitInfo>();
+  if (pitInfo == nullptr) {
+    return;
+  }
+  auto it = std::find(pitInfo->counted.begin(), pitInfo->counted.end(), inFace.getId());
+  if (it != pitInfo->counted.end()) {
+    pitInfo->counted.erase(it);
+    m_outstanding[inFace.getId()]--;
+  }
+}
+
+void
+LoadAwareSiteStrategy::beforeExpirePendingInterest(const shared_ptr<pit::Entry>& pitEntry)
+{
+  releaseAll(pitEntry);
+}
+
+void
+LoadAwareSiteStrategy::releaseAll(const shared_ptr<pit::Entry>& pitEntry)
+{
+  auto pitInfo = pitEntry->getStrategyInfo<LoadAwarePitInfo>();
+  if (pitInfo == nullptr) {
+    return;
+  }
+  for (FaceId face : pitInfo->counted) {
+    m_outstanding[face]--;
+  }
+  pitInfo->counted.clear();
+}
+
+} // namespace fw
+} // namespace nfd
@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2016,  Regents of the University of California,
+ *                           Arizona Board of Regents,
+ *                           Colorado State University,
+ *                           University Pierre & Marie Curie, Sorbonne University,
+ *                           Washington University in St. Louis,
+ *                           Beijing Institute of Technology,
+ *                           The University of Memphis.
+ *
+ * Copyright (c) 2017 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of NFD (Named Data Networking Forwarding Daemon).
+ * See AUTHORS.md for complete list of NFD authors and contributors.
+ *
+ * NFD is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * NFD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * NFD, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NFD_DAEMON_FW_LOAD_AWARE_SITE_STRATEGY_HPP
+#define NFD_DAEMON_FW_LOAD_AWARE_SITE_STRATEGY_HPP
+
+#include "fw/strategy.hpp"
+
+#include <random>
+#include <unordered_map>
+
+namespace nfd {
+namespace fw {
+
+class LoadAwarePitInfo;
+class LoadAwareMeasurementInfo;
+
+/** \brief a site selection strategy that spreads Interests over nearby sites
+ *
+ * Like CloserSiteStrategy it measures the delay of every nexthop, but it also
+ * counts the Interests each face has outstanding, from the out-records of the PIT
+ * entries it forwarded. Faces whose smoothed delay is within the delay tolerance
+ * of the best one are candidates, scored by delay plus a per-Interest load
+ * penalty; one of them is chosen by power-of-two-choices or by weighted random
+ * selection. Until a face has been measured Interests are multicast.
+ */
+class LoadAwareSiteStrategy : public Strategy
+{
+public:
+  enum Selection {
+    POWER_OF_TWO,
+    WEIGHTED
+  };
+
+  struct Parameters
+  {
+    time::milliseconds tolerance = time::milliseconds(20);
+    time::milliseconds loadPenalty = time::milliseconds(5); // per outstanding Interest
+    Selection selection = POWER_OF_TWO;
+  };
+
+  LoadAwareSiteStrategy(Forwarder& forwarder, const Name& name = STRATEGY_NAME);
+
+  /** \brief parameters of every instance created afterwards
+   */
+  static Parameters&
+  getParameters();
+
+  virtual void
+  afterReceiveInterest(const Face& inFace, const Interest& interest,
+                       const shared_ptr<pit::Entry>& pitEntry) override;
+
+  virtual void
+  beforeSatisfyInterest(const shared_ptr<pit::Entry>& pitEntry,
+                        const Face& inFace,
+                        const Data& data) override;
+
+  virtual void
+  afterReceiveNack(const Face& inFace, const lp::Nack& nack,
+                   const shared_ptr<pit::Entry>& pitEntry) override;
+
+  virtual void
+  beforeExpirePendingInterest(const shared_ptr<pit::Entry>& pitEntry) override;
+
+  uint32_t
+  getOutstanding(FaceId face) const;
+
+private:
+  Face*
+  selectFace(const std::vector<Face*>& candidates, const LoadAwareMeasurementInfo& info);
+
+  double
+  score(Face& face, const LoadAwareMeasurementInfo& info) const;
+
+  void
+  releaseAll(const shared_ptr<pit::Entry>& pitEntry);
+
+public:
+  static const Name STRATEGY_NAME;
+
+private:
+  Parameters m_params;
+  std::unordered_map<FaceId, uint32_t> m_outstanding;
+  std::mt19937 m_rng;
+};
+
+} // namespace fw
+} // namespace nfd
+
+#endif // NFD_DAEMON_FW_LOAD_AWARE_SITE_STRATEGY_HPP
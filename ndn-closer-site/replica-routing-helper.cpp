@@ -0,0 +1,64 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ * Copyright (c) 2017 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "replica-routing-helper.hpp"
+
+#include "ns3/log.h"
+
+#include "model/ndn-l3-protocol.hpp"
+#include "NFD/daemon/fw/forwarder.hpp"
+
+NS_LOG_COMPONENT_DEFINE("ndn.ReplicaRoutingHelper");
+
+namespace ns3 {
+namespace ndn {
+
+void
+ReplicaRoutingHelper::AddReplica(GlobalRoutingHelper& routingHelper, const Name& dataset,
+                                 Ptr<Node> replica)
+{
+  routingHelper.AddOrigins(dataset.toUri(), replica);
+  m_replicas.push_back(std::make_pair(dataset, replica));
+}
+
+size_t
+ReplicaRoutingHelper::GetNReplicas() const
+{
+  return m_replicas.size();
+}
+
+uint32_t
+ReplicaRoutingHelper::ServeLocally() const
+{
+  uint32_t removed = 0;
+  for (const auto& replica : m_replicas) {
+    Ptr<L3Protocol> l3 = replica.second->GetObject<L3Protocol>();
+    nfd::Fib& fib = l3->getForwarder()->getFib();
+    if (fib.findExactMatch(replica.first) != nullptr) {
+      NS_LOG_DEBUG("Node " << replica.second->GetId() << " serves " << replica.first);
+      fib.erase(replica.first);
+      removed++;
+    }
+  }
+  return removed;
+}
+
+} // namespace ndn
+} // namespace ns3
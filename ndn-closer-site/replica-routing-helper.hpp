@@ -0,0 +1,70 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ * Copyright (c) 2017 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_CLOSER_SITE_REPLICA_ROUTING_HELPER_HPP
+#define NDN_CLOSER_SITE_REPLICA_ROUTING_HELPER_HPP
+
+#include "ns3/ndnSIM/model/ndn-common.hpp"
+#include "ns3/ndnSIM/helper/ndn-global-routing-helper.hpp"
+
+#include "ns3/node.h"
+#include "ns3/ptr.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/** \brief routes to the replicas of a dataset placement
+ *
+ * Each replica announces <prefix>/<dataset> with GlobalRoutingHelper::AddOrigins,
+ * while its producer app only registers <prefix>. CalculateAllPossibleRoutes gives
+ * a replica routes to the other replicas of its datasets, and as the longer prefix
+ * they would win over the app's route, sending the Interests away from the replica
+ * that holds the data. ServeLocally removes those entries again once the routes
+ * are installed, so each replica answers its datasets from its own app.
+ */
+class ReplicaRoutingHelper
+{
+public:
+  /** \brief announce the dataset prefix from the replica
+   */
+  void
+  AddReplica(GlobalRoutingHelper& routingHelper, const Name& dataset, Ptr<Node> replica);
+
+  size_t
+  GetNReplicas() const;
+
+  /** \brief drop the routes each replica got for its own datasets, after the
+   *         routes are calculated; returns the number of FIB entries removed
+   */
+  uint32_t
+  ServeLocally() const;
+
+private:
+  std::vector<std::pair<Name, Ptr<Node>>> m_replicas;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_CLOSER_SITE_REPLICA_ROUTING_HELPER_HPP
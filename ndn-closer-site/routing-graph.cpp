@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ * Copyright (c) 2017 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "routing-graph.hpp"
+
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+
+#include "model/ndn-global-router.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+
+namespace ns3 {
+namespace ndn {
+
+const uint64_t RoutingGraph::UNREACHABLE;
+
+void
+RoutingGraph::Read()
+{
+  uint32_t n = NodeList::GetNNodes();
+  out.assign(n, std::vector<Edge>());
+  in.assign(n, std::vector<std::pair<uint32_t, size_t>>());
+  origins.clear();
+  for (NodeList::Iterator node = NodeList::Begin(); node != NodeList::End(); ++node) {
+    Ptr<GlobalRouter> router = (*node)->GetObject<GlobalRouter>();
+    if (router == nullptr) {
+      continue;
+    }
+    uint32_t v = (*node)->GetId();
+    for (const auto& incidency : router->GetIncidencies()) {
+      const shared_ptr<Face>& face = std::get<1>(incidency);
+      uint32_t u = std::get<2>(incidency)->GetObject<Node>()->GetId();
+      in[u].push_back(std::make_pair(v, out[v].size()));
+      out[v].push_back(Edge{u, face, static_cast<uint64_t>(face->getMetric()), true});
+    }
+    for (const auto& prefix : router->GetLocalPrefixes()) {
+      origins[*prefix].push_back(v);
+    }
+  }
+}
+
+bool
+RoutingGraph::IsLinked(uint32_t a, uint32_t b) const
+{
+  if (a >= out.size()) {
+    return false;
+  }
+  for (const Edge& edge : out[a]) {
+    if (edge.neighbour == b) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void
+RoutingGraph::Propagate(std::vector<uint64_t>& distance, std::vector<int64_t>& parent, Queue& queue,
+                        std::vector<uint32_t>& changed) const
+{
+  std::greater<Queue::value_type> later;
+  while (!queue.empty()) {
+    std::pop_heap(queue.begin(), queue.end(), later);
+    Queue::value_type top = queue.back();
+    queue.pop_back();
+    if (top.first > distance[top.second]) {
+      continue;
+    }
+    for (const auto& link : in[top.second]) {
+      const Edge& edge = out[link.first][link.second];
+      if (!edge.up) {
+        continue;
+      }
+      uint64_t d = top.first + edge.metric;
+      if (d < distance[link.first]) {
+        distance[link.first] = d;
+        parent[link.first] = top.second;
+        changed.push_back(link.first);
+        queue.push_back(std::make_pair(d, link.first));
+        std::push_heap(queue.begin(), queue.end(), later);
+      }
+    }
+  }
+}
+
+void
+RoutingGraph::RankNextHops(const std::vector<uint64_t>& distance, uint32_t node, uint32_t k,
+                           std::vector<std::pair<uint64_t, size_t>>& ranked) const
+{
+  ranked.clear();
+  // origins serve the prefix themselves
+  if (distance[node] == 0 || distance[node] == UNREACHABLE) {
+    return;
+  }
+  for (size_t e = 0; e < out[node].size(); e++) {
+    const Edge& edge = out[node][e];
+    if (edge.up && distance[edge.neighbour] < distance[node]) {
+      ranked.push_back(std::make_pair(distance[edge.neighbour] + edge.metric, e));
+    }
+  }
+  size_t keep = k > 0 ? std::min<size_t>(k, ranked.size()) : ranked.size();
+  std::partial_sort(ranked.begin(), ranked.begin() + keep, ranked.end());
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,93 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ * Copyright (c) 2017 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_CLOSER_SITE_ROUTING_GRAPH_HPP
+#define NDN_CLOSER_SITE_ROUTING_GRAPH_HPP
+
+#include "ns3/ndnSIM/model/ndn-common.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/** \brief links and origins of the GlobalRouter nodes, shared by the route helpers
+ *
+ * Distances are to the nearest origin of a prefix, over the links into each node,
+ * from a multi-source Dijkstra. A node's next hops for the prefix are its faces to
+ * neighbours strictly closer to an origin, worth the face metric plus that
+ * neighbour's distance; faces toward neighbours at the same or a larger distance
+ * are left out, as their path may come back through the node.
+ */
+class RoutingGraph
+{
+public:
+  static const uint64_t UNREACHABLE = std::numeric_limits<uint64_t>::max();
+
+  struct Edge
+  {
+    uint32_t neighbour;
+    shared_ptr<Face> face;
+    uint64_t metric;
+    bool up;
+  };
+
+  // binary min-heap of (distance, node)
+  typedef std::vector<std::pair<uint64_t, uint32_t>> Queue;
+
+  /** \brief read the links and origins of all nodes
+   */
+  void
+  Read();
+
+  bool
+  IsLinked(uint32_t a, uint32_t b) const;
+
+  /** \brief Dijkstra over the up links from the queued nodes
+   *
+   * Every node whose distance improves gets the node it goes through as parent and
+   * is appended to changed.
+   */
+  void
+  Propagate(std::vector<uint64_t>& distance, std::vector<int64_t>& parent, Queue& queue,
+            std::vector<uint32_t>& changed) const;
+
+  /** \brief (cost, index in out[node]) of the node's possible next hops
+   *
+   * The k cheapest (all of them for k = 0) come first, in order of cost.
+   */
+  void
+  RankNextHops(const std::vector<uint64_t>& distance, uint32_t node, uint32_t k,
+               std::vector<std::pair<uint64_t, size_t>>& ranked) const;
+
+public:
+  std::vector<std::vector<Edge>> out;                        // faces of each node
+  std::vector<std::vector<std::pair<uint32_t, size_t>>> in;  // (node, index in its out) of the links into each node
+  std::map<Name, std::vector<uint32_t>> origins;             // nodes announcing each prefix
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_CLOSER_SITE_ROUTING_GRAPH_HPP
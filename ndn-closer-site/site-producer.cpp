@@ -0,0 +1,326 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ * Copyright (c) 2017 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "site-producer.hpp"
+#include "../llnl/llnl_virtual_payload.hpp"
+
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/names.h"
+#include "ns3/node-list.h"
+
+#include "model/ndn-l3-protocol.hpp"
+#include "helper/ndn-fib-helper.hpp"
+
+#include <boost/algorithm/string.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE("ndn.SiteProducer");
+
+namespace ns3 {
+namespace ndn {
+
+NS_OBJECT_ENSURE_REGISTERED(SiteProducer);
+
+// jobs with less than this many bytes left are done
+static const double DONE_BYTES = 1.0;
+
+TypeId
+SiteProducer::GetTypeId(void)
+{
+  static TypeId tid =
+    TypeId("ns3::ndn::SiteProducer")
+      .SetGroupName("Ndn")
+      .SetParent<App>()
+      .AddConstructor<SiteProducer>()
+      .AddAttribute("Prefix", "Prefix, for which producer has the data", StringValue("/"),
+                    MakeNameAccessor(&SiteProducer::m_prefix), MakeNameChecker())
+      .AddAttribute("Postfix", "Postfix that is added to the output data (e.g., for adding producer-uniqueness)",
+                    StringValue("/"), MakeNameAccessor(&SiteProducer::m_postfix), MakeNameChecker())
+      .AddAttribute("PayloadSize", "Virtual payload size for Content packets", UintegerValue(1024),
+                    MakeUintegerAccessor(&SiteProducer::m_virtualPayloadSize),
+                    MakeUintegerChecker<uint32_t>())
+      .AddAttribute("Freshness", "Freshness of data packets, if 0, then unlimited freshness",
+                    TimeValue(Seconds(0)), MakeTimeAccessor(&SiteProducer::m_freshness),
+                    MakeTimeChecker())
+      .AddAttribute("Signature", "Fake signature, 0 valid signature (default), other values application-specific",
+                    UintegerValue(0), MakeUintegerAccessor(&SiteProducer::m_signature),
+                    MakeUintegerChecker<uint32_t>())
+      .AddAttribute("KeyLocator", "Name to be used for key locator.  If root, then key locator is not used",
+                    NameValue(), MakeNameAccessor(&SiteProducer::m_keyLocator), MakeNameChecker())
+      .AddAttribute("DiskRate", "Rate at which segments are read from disk", DataRateValue(DataRate("10Gbps")),
+                    MakeDataRateAccessor(&SiteProducer::m_diskRate), MakeDataRateChecker())
+      .AddAttribute("EgressRate", "Rate at which the server can send out", DataRateValue(DataRate("10Gbps")),
+                    MakeDataRateAccessor(&SiteProducer::m_egressRate), MakeDataRateChecker())
+      .AddAttribute("Concurrency", "Maximum number of segments in service at once", UintegerValue(8),
+                    MakeUintegerAccessor(&SiteProducer::m_concurrency), MakeUintegerChecker<uint32_t>(1))
+      .AddAttribute("Discipline", "FIFO or PS (processor sharing)", StringValue("FIFO"),
+                    MakeStringAccessor(&SiteProducer::m_discipline), MakeStringChecker())
+      .AddAttribute("SegmentSize", "Bytes per segment when virtual payloads are off", UintegerValue(100000000),
+                    MakeUintegerAccessor(&SiteProducer::m_segmentSize), MakeUintegerChecker<uint64_t>());
+  return tid;
+}
+
+SiteProducer::SiteProducer()
+{
+  NS_LOG_FUNCTION_NOARGS();
+}
+
+const SiteProducer::Stats&
+SiteProducer::GetStats() const
+{
+  return m_stats;
+}
+
+double
+SiteProducer::GetMeanQueue() const
+{
+  double elapsed = (m_lastUpdate - m_started).GetSeconds();
+  return elapsed > 0 ? m_stats.queueIntegral / elapsed : 0;
+}
+
+double
+SiteProducer::GetUtilisation() const
+{
+  double elapsed = (m_lastUpdate - m_started).GetSeconds();
+  return elapsed > 0 ? m_stats.busyIntegral / elapsed : 0;
+}
+
+void
+SiteProducer::StartApplication()
+{
+  NS_LOG_FUNCTION_NOARGS();
+  NS_ABORT_MSG_IF(m_discipline != "FIFO" && m_discipline != "PS",
+                  "Unknown service discipline " << m_discipline);
+  App::StartApplication();
+
+  FibHelper::AddRoute(GetNode(), m_prefix, m_face, 0);
+  m_started = m_lastUpdate = Simulator::Now();
+}
+
+void
+SiteProducer::StopApplication()
+{
+  NS_LOG_FUNCTION_NOARGS();
+  Advance();
+  Simulator::Cancel(m_completion);
+  m_waiting.clear();
+  m_inService.clear();
+
+  App::StopApplication();
+}
+
+void
+SiteProducer::OnInterest(shared_ptr<const Interest> interest)
+{
+  App::OnInterest(interest); // tracing inside
+
+  NS_LOG_FUNCTION(this << interest);
+
+  if (!m_active)
+    return;
+
+  Advance();
+
+  uint64_t bytes = m_segmentSize;
+  if (LlnlPayloadSizes::Get().IsEnabled()) {
+    bytes = LlnlPayloadSizes::Get().GetSize(interest->getName());
+  }
+  m_waiting.push_back(Job{interest, Simulator::Now(), static_cast<double>(bytes)});
+  m_stats.arrived++;
+  m_stats.maxQueue = std::max<uint32_t>(m_stats.maxQueue, m_waiting.size() + m_inService.size());
+
+  StartJobs();
+  Reschedule();
+}
+
+double
+SiteProducer::ServiceRate() const
+{
+  return std::min(m_diskRate.GetBitRate(), m_egressRate.GetBitRate()) / 8.0;
+}
+
+// bytes per second each job in service gets
+double
+SiteProducer::JobRate() const
+{
+  if (m_discipline == "PS") {
+    return m_inService.empty() ? ServiceRate() : ServiceRate() / m_inService.size();
+  }
+  return ServiceRate() / m_concurrency;
+}
+
+// bring the remaining bytes and the time integrals up to now
+void
+SiteProducer::Advance()
+{
+  double dt = (Simulator::Now() - m_lastUpdate).GetSeconds();
+  m_lastUpdate = Simulator::Now();
+  if (dt <= 0) {
+    return;
+  }
+
+  double rate = JobRate();
+  for (auto& job : m_inService) {
+    job.remaining -= rate * dt;
+  }
+
+  double busy = 0;
+  if (!m_inService.empty()) {
+    busy = m_discipline == "PS" ? 1.0 : static_cast<double>(m_inService.size()) / m_concurrency;
+  }
+  m_stats.queueIntegral += (m_waiting.size() + m_inService.size()) * dt;
+  m_stats.busyIntegral += busy * dt;
+}
+
+void
+SiteProducer::StartJobs()
+{
+  while (!m_waiting.empty() && m_inService.size() < m_concurrency) {
+    m_stats.started++;
+    m_stats.waitSum += (Simulator::Now() - m_waiting.front().arrival).GetSeconds();
+    m_inService.push_back(std::move(m_waiting.front()));
+    m_waiting.pop_front();
+  }
+}
+
+// all jobs in service progress at the same rate, the one with the fewest bytes
+// left finishes first
+void
+SiteProducer::Reschedule()
+{
+  Simulator::Cancel(m_completion);
+  if (m_inService.empty()) {
+    return;
+  }
+  double left = std::min_element(m_inService.begin(), m_inService.end(),
+                                 [] (const Job& a, const Job& b) { return a.remaining < b.remaining; })->remaining;
+  // round up, so the job is done by the time the event runs
+  double delay = std::ceil(std::max(left, 0.0) / JobRate() * 1e9);
+  m_completion = Simulator::Schedule(NanoSeconds(static_cast<int64_t>(delay)),
+                                     &SiteProducer::OnCompletion, this);
+}
+
+void
+SiteProducer::OnCompletion()
+{
+  Advance();
+  for (auto job = m_inService.begin(); job != m_inService.end();) {
+    if (job->remaining < DONE_BYTES) {
+      m_stats.served++;
+      m_stats.responseSum += (Simulator::Now() - job->arrival).GetSeconds();
+      SendData(*job->interest);
+      job = m_inService.erase(job);
+    }
+    else {
+      ++job;
+    }
+  }
+  StartJobs();
+  Reschedule();
+}
+
+void
+SiteProducer::SendData(const Interest& interest)
+{
+  if (!m_active)
+    return;
+
+  Name dataName(interest.getName());
+  auto data = make_shared<Data>();
+  data->setName(dataName);
+  data->setFreshnessPeriod(::ndn::time::milliseconds(m_freshness.GetMilliSeconds()));
+
+  data->setContent(make_shared< ::ndn::Buffer>(m_virtualPayloadSize));
+
+  Signature signature;
+  SignatureInfo signatureInfo(static_cast< ::ndn::tlv::SignatureTypeValue>(255));
+
+  if (m_keyLocator.size() > 0) {
+    signatureInfo.setKeyLocator(m_keyLocator);
+  }
+
+  signature.setInfo(signatureInfo);
+  signature.setValue(::ndn::makeNonNegativeIntegerBlock(::ndn::tlv::SignatureValue, m_signature));
+
+  data->setSignature(signature);
+
+  NS_LOG_INFO("node(" << GetNode()->GetId() << ") responding with Data: " << data->getName());
+
+  // to create real wire encoding
+  data->wireEncode();
+
+  m_transmittedDatas(data, this, m_face);
+  m_appLink->onReceiveData(*data);
+}
+
+std::map<std::string, std::vector<std::string>>
+SiteProducer::ReadParams(const std::string& fileName)
+{
+  std::map<std::string, std::vector<std::string>> params;
+  std::ifstream is(fileName);
+  std::string line;
+  while (getline(is, line)) {
+    line = line.substr(0, line.find('#'));
+    boost::trim(line);
+    if (line.empty()) {
+      continue;
+    }
+    std::vector<std::string> parts;
+    boost::split(parts, line, boost::is_any_of(" \t"), boost::token_compress_on);
+    if (parts.size() != 5) {
+      std::cout << "Ignoring server parameters " << line << std::endl;
+      continue;
+    }
+    params[parts[0]] = std::vector<std::string>(parts.begin() + 1, parts.end());
+  }
+  return params;
+}
+
+void
+SiteProducer::WriteStats(const std::string& fileName)
+{
+  std::ofstream os(fileName);
+  os << "server\tarrived\tserved\tmean_queue\tmax_queue\tutilisation\tmean_wait\tmean_response\n";
+  for (NodeList::Iterator node = NodeList::Begin(); node != NodeList::End(); ++node) {
+    for (uint32_t a = 0; a < (*node)->GetNApplications(); a++) {
+      Ptr<SiteProducer> producer = DynamicCast<SiteProducer>((*node)->GetApplication(a));
+      if (producer == nullptr) {
+        continue;
+      }
+      producer->Advance();
+      const Stats& s = producer->m_stats;
+      os << Names::FindName(*node) << "\t" << s.arrived << "\t" << s.served << "\t"
+         << producer->GetMeanQueue() << "\t" << s.maxQueue << "\t" << producer->GetUtilisation() << "\t"
+         << (s.started > 0 ? s.waitSum / s.started : 0) << "\t"
+         << (s.served > 0 ? s.responseSum / s.served : 0) << "\n";
+    }
+  }
+}
+
+} // namespace ndn
+} // namespace ns3
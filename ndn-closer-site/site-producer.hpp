@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ * Copyright (c) 2017 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_CLOSER_SITE_SITE_PRODUCER_HPP
+#define NDN_CLOSER_SITE_SITE_PRODUCER_HPP
+
+#include "ns3/ndnSIM/model/ndn-common.hpp"
+#include "ns3/ndnSIM/apps/ndn-app.hpp"
+
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/data-rate.h"
+
+#include <deque>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/** \brief a producer with finite capacity
+ *
+ * Every Interest is a job of one segment. Jobs are read from disk and sent out at
+ * min(DiskRate, EgressRate); at most Concurrency jobs are in service, the others
+ * wait in arrival order. With the FIFO discipline each job in service gets an
+ * equal 1/Concurrency share of the rate, with PS (processor sharing) the jobs in
+ * service split the whole rate among themselves. The Data is answered when its
+ * job completes.
+ */
+class SiteProducer : public App
+{
+public:
+  static TypeId
+  GetTypeId();
+
+  SiteProducer();
+
+  struct Stats
+  {
+    uint64_t arrived = 0;
+    uint64_t started = 0;
+    uint64_t served = 0;
+    uint32_t maxQueue = 0;   // waiting plus in service
+    double queueIntegral = 0; // jobs * seconds
+    double busyIntegral = 0;  // fraction of the rate in use * seconds
+    double waitSum = 0;       // seconds from arrival to start of service
+    double responseSum = 0;   // seconds from arrival to Data
+  };
+
+  const Stats&
+  GetStats() const;
+
+  /** \brief time-averaged number of jobs, and of the rate in use, so far
+   */
+  double
+  GetMeanQueue() const;
+
+  double
+  GetUtilisation() const;
+
+  /** \brief read per-server parameters, one "<server> <disk rate> <egress rate>
+   *         <concurrency> <FIFO|PS>" line per server, '#' starts a comment
+   */
+  static std::map<std::string, std::vector<std::string>>
+  ReadParams(const std::string& fileName);
+
+  /** \brief write a row of stats for every SiteProducer in the simulation
+   */
+  static void
+  WriteStats(const std::string& fileName);
+
+protected:
+  virtual void
+  StartApplication() override;
+
+  virtual void
+  StopApplication() override;
+
+  virtual void
+  OnInterest(shared_ptr<const Interest> interest) override;
+
+private:
+  struct Job
+  {
+    shared_ptr<const Interest> interest;
+    Time arrival;
+    double remaining; // bytes
+  };
+
+  double
+  ServiceRate() const;
+
+  double
+  JobRate() const;
+
+  void
+  Advance();
+
+  void
+  StartJobs();
+
+  void
+  Reschedule();
+
+  void
+  OnCompletion();
+
+  void
+  SendData(const Interest& interest);
+
+private:
+  Name m_prefix;
+  Name m_postfix;
+  uint32_t m_virtualPayloadSize;
+  Time m_freshness;
+  uint32_t m_signature;
+  Name m_keyLocator;
+
+  DataRate m_diskRate;
+  DataRate m_egressRate;
+  uint32_t m_concurrency;
+  std::string m_discipline;
+  uint64_t m_segmentSize;
+
+  std::deque<Job> m_waiting;
+  std::list<Job> m_inService;
+  Time m_lastUpdate;
+  Time m_started;
+  EventId m_completion;
+  Stats m_stats;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_CLOSER_SITE_SITE_PRODUCER_HPP
@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// k_best_routing_test.cpp
+//
+// On a star with the producer on one leaf, KBestRoutingHelper with room for every
+// face installs only routes toward the producer: the hub points to the producer's
+// leaf alone and no face points toward another leaf. Built like a scenario, from the
+// ndnSIM scenario tree.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/ndnSIM-module.h"
+
+#include "model/ndn-global-router.hpp"
+#include "NFD/daemon/fw/forwarder.hpp"
+
+#include "ndn-closer-site/k-best-routing-helper.hpp"
+
+#include <cstdio>
+#include <map>
+#include <tuple>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                   \
+  do {                                                                     \
+    if (!(condition)) {                                                    \
+      std::fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+      failures++;                                                          \
+    }                                                                      \
+  } while (0)
+
+using namespace ns3;
+
+// the nodes the next hops of the prefix lead to
+static std::vector<uint32_t>
+nextHopNodes(Ptr<Node> node, const ndn::Name& prefix)
+{
+  std::map<nfd::FaceId, uint32_t> neighbours;
+  Ptr<ndn::GlobalRouter> router = node->GetObject<ndn::GlobalRouter>();
+  for (const auto& incidency : router->GetIncidencies()) {
+    neighbours[std::get<1>(incidency)->getId()] = std::get<2>(incidency)->GetObject<Node>()->GetId();
+  }
+
+  std::vector<uint32_t> nodes;
+  Ptr<ndn::L3Protocol> l3 = node->GetObject<ndn::L3Protocol>();
+  const nfd::fib::Entry* entry = l3->getForwarder()->getFib().findExactMatch(prefix);
+  if (entry != nullptr) {
+    for (const nfd::fib::NextHop& nexthop : entry->getNextHops()) {
+      nodes.push_back(neighbours[nexthop.getFace().getId()]);
+    }
+  }
+  return nodes;
+}
+
+int
+main()
+{
+  // node 0 is the hub, 1..4 the leaves, the producer is on leaf 1
+  NodeContainer nodes;
+  nodes.Create(5);
+  PointToPointHelper p2p;
+  for (uint32_t leaf = 1; leaf < nodes.GetN(); leaf++) {
+    p2p.Install(nodes.Get(0), nodes.Get(leaf));
+  }
+
+  ndn::StackHelper ndnHelper;
+  ndnHelper.InstallAll();
+  ndn::GlobalRoutingHelper routingHelper;
+  routingHelper.InstallAll();
+  ndn::Name prefix("/cmip5/app");
+  routingHelper.AddOrigins(prefix.toUri(), nodes.Get(1));
+
+  ndn::KBestRoutingHelper::Stats stats = ndn::KBestRoutingHelper::CalculateRoutes(nodes.GetN());
+  CHECK(stats.prefixes == 1);
+  // one route at the hub and one at each of the other leaves
+  CHECK(stats.routes == nodes.GetN() - 1);
+
+  std::vector<uint32_t> hub = nextHopNodes(nodes.Get(0), prefix);
+  CHECK(hub.size() == 1 && hub[0] == 1);
+  CHECK(nextHopNodes(nodes.Get(1), prefix).empty());
+  for (uint32_t leaf = 2; leaf < nodes.GetN(); leaf++) {
+    std::vector<uint32_t> hops = nextHopNodes(nodes.Get(leaf), prefix);
+    CHECK(hops.size() == 1 && hops[0] == 0);
+  }
+
+  Simulator::Destroy();
+  if (failures == 0) {
+    std::printf("k_best_routing_test: OK\n");
+  }
+  return failures == 0 ? 0 : 1;
+}
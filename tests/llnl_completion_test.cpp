@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_completion_test.cpp
+//
+// A download driven the way the consumers drive it (a pipeline of the first segments,
+// then the next segment on every Data) is reported complete once every segment it
+// asked for has arrived, and not before.
+//
+//   g++ -std=c++11 -I. tests/llnl_completion_test.cpp -o llnl_completion_test
+
+#include "llnl/llnl_completion.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <set>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                   \
+    do {                                                                   \
+        if (!(condition)) {                                                \
+            std::fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+// deliver every requested segment once, duplicating some, in request order
+static void
+checkDownload(uint64_t maxSegment, uint32_t pipelineSize)
+{
+    app::DownloadProgress progress(maxSegment);
+    uint32_t requested = 0;
+    std::deque<uint64_t> inFlight;
+    std::set<uint64_t> asked;
+
+    uint32_t pipeline = std::min(static_cast<uint32_t>(maxSegment), pipelineSize);
+    for (uint32_t i = 0; i < pipeline; i++) {
+        uint64_t segment;
+        CHECK(app::DownloadProgress::NextSegment(requested, maxSegment, segment));
+        inFlight.push_back(segment);
+    }
+
+    size_t delivered = 0;
+    bool completed = false;
+    while (!inFlight.empty()) {
+        uint64_t segment = inFlight.front();
+        inFlight.pop_front();
+        CHECK(asked.insert(segment).second);
+        CHECK(!completed);
+        completed = progress.Receive(segment);
+        // a retransmitted copy never counts twice
+        if (segment % 3 == 0) {
+            CHECK(!progress.Receive(segment));
+        }
+        delivered++;
+        CHECK(progress.IsComplete() == (delivered == maxSegment));
+
+        uint64_t next;
+        if (app::DownloadProgress::NextSegment(requested, maxSegment, next)) {
+            inFlight.push_back(next);
+        }
+    }
+
+    CHECK(completed);
+    CHECK(progress.IsComplete());
+    CHECK(asked.size() == maxSegment);
+    CHECK(*asked.rbegin() == maxSegment - 1);
+    CHECK(requested == maxSegment);
+}
+
+int
+main()
+{
+    checkDownload(1, 64);
+    checkDownload(5, 64);
+    checkDownload(64, 64);
+    checkDownload(65, 64);
+    checkDownload(1000, 64);
+    checkDownload(10, 1);
+
+    // a segment outside the download is ignored
+    app::DownloadProgress progress(2);
+    CHECK(!progress.Receive(2));
+    CHECK(!progress.Receive(0));
+    CHECK(progress.Receive(1));
+
+    if (failures == 0) {
+        std::printf("llnl_completion_test: OK\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
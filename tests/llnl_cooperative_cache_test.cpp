@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// llnl_cooperative_cache_test.cpp
+//
+// Detours of in-flight segments of one download, which share the nonce of its first
+// Interest, are kept apart: setting or clearing one leaves the others in place.
+// Built like a scenario, from the ndnSIM scenario tree.
+
+#include "ns3/core-module.h"
+#include "ns3/ndnSIM-module.h"
+
+#include "llnl/llnl_cooperative_cache.hpp"
+
+#include <cstdio>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                   \
+  do {                                                                     \
+    if (!(condition)) {                                                    \
+      std::fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+      failures++;                                                          \
+    }                                                                      \
+  } while (0)
+
+static ns3::ndn::Interest
+makeInterest(uint64_t segment, uint32_t nonce)
+{
+  ns3::ndn::Interest interest(ns3::ndn::Name("/cmip5/app/dataset").appendSegment(3).appendSegment(segment));
+  interest.setNonce(nonce);
+  return interest;
+}
+
+int
+main()
+{
+  auto& coop = ns3::LlnlCooperativeCache::Get();
+  ns3::ndn::Interest first = makeInterest(0, 42);
+  ns3::ndn::Interest second = makeInterest(1, 42);
+  ns3::ndn::Interest third = makeInterest(2, 42);
+
+  // two segments on detours to different holders
+  coop.SetDetour(first, 5);
+  coop.SetDetour(second, 7);
+  CHECK(coop.GetDetour(first) == 5);
+  CHECK(coop.GetDetour(second) == 7);
+  CHECK(coop.GetDetour(third) == -1);
+
+  // the same name with another nonce is another Interest
+  CHECK(coop.GetDetour(makeInterest(0, 43)) == -1);
+
+  // the first segment's Data clears only its own detour
+  coop.ClearDetour(first.getNonce(), first.getName());
+  CHECK(coop.GetDetour(first) == -1);
+  CHECK(coop.GetDetour(second) == 7);
+
+  coop.ClearDetour(second.getNonce(), second.getName());
+  CHECK(coop.GetDetour(second) == -1);
+
+  if (failures == 0) {
+    std::printf("llnl_cooperative_cache_test: OK\n");
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2016 susmit@colostate.edu, chengyu.fan@colostate.edu
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+
+// replica_routing_test.cpp
+//
+// A dataset placed on two servers, with all possible routes installed, is served
+// by the replica closer to the client: the replicas do not forward its Interests
+// to each other. Built like a scenario, from the ndnSIM scenario tree.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/ndnSIM-module.h"
+
+#include "ndn-closer-site/replica-routing-helper.hpp"
+
+#include <cstdio>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                   \
+  do {                                                                     \
+    if (!(condition)) {                                                    \
+      std::fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+      failures++;                                                          \
+    }                                                                      \
+  } while (0)
+
+using namespace ns3;
+
+static void
+countInterest(uint64_t* count, shared_ptr<const ndn::Interest>, Ptr<ndn::App>, shared_ptr<ndn::Face>)
+{
+  (*count)++;
+}
+
+static void
+countData(uint64_t* count, shared_ptr<const ndn::Data>, Ptr<ndn::App>, shared_ptr<ndn::Face>)
+{
+  (*count)++;
+}
+
+int
+main()
+{
+  // client 0, the near replica 1 is one hop away, the far replica 3 two hops via 2
+  NodeContainer nodes;
+  nodes.Create(4);
+  PointToPointHelper p2p;
+  p2p.Install(nodes.Get(0), nodes.Get(1));
+  p2p.Install(nodes.Get(0), nodes.Get(2));
+  p2p.Install(nodes.Get(2), nodes.Get(3));
+
+  ndn::StackHelper ndnHelper;
+  ndnHelper.InstallAll();
+  ndn::StrategyChoiceHelper::InstallAll("/cmip5/app", "/localhost/nfd/strategy/best-route");
+
+  ndn::AppHelper producerHelper("ns3::ndn::Producer");
+  producerHelper.SetPrefix("/cmip5/app");
+  producerHelper.SetAttribute("PayloadSize", StringValue("1024"));
+  ApplicationContainer near = producerHelper.Install(nodes.Get(1));
+  ApplicationContainer far = producerHelper.Install(nodes.Get(3));
+
+  ndn::AppHelper consumerHelper("ns3::ndn::ConsumerCbr");
+  consumerHelper.SetPrefix("/cmip5/app/dataset");
+  consumerHelper.SetAttribute("Frequency", StringValue("10"));
+  consumerHelper.SetAttribute("MaxSeq", StringValue("20"));
+  ApplicationContainer consumer = consumerHelper.Install(nodes.Get(0));
+
+  uint64_t nearInterests = 0, farInterests = 0, received = 0;
+  near.Get(0)->TraceConnectWithoutContext("ReceivedInterests", MakeBoundCallback(&countInterest, &nearInterests));
+  far.Get(0)->TraceConnectWithoutContext("ReceivedInterests", MakeBoundCallback(&countInterest, &farInterests));
+  consumer.Get(0)->TraceConnectWithoutContext("ReceivedDatas", MakeBoundCallback(&countData, &received));
+
+  ndn::GlobalRoutingHelper routingHelper;
+  routingHelper.InstallAll();
+  routingHelper.AddOrigins("/cmip5/app", nodes.Get(1));
+  routingHelper.AddOrigins("/cmip5/app", nodes.Get(3));
+  ndn::ReplicaRoutingHelper replicaRouting;
+  replicaRouting.AddReplica(routingHelper, "/cmip5/app/dataset", nodes.Get(1));
+  replicaRouting.AddReplica(routingHelper, "/cmip5/app/dataset", nodes.Get(3));
+  ndn::GlobalRoutingHelper::CalculateAllPossibleRoutes();
+  CHECK(replicaRouting.ServeLocally() == 2);
+
+  Simulator::Stop(Seconds(5));
+  Simulator::Run();
+  Simulator::Destroy();
+
+  CHECK(received == 20);
+  CHECK(nearInterests == 20);
+  CHECK(farInterests == 0);
+
+  if (failures == 0) {
+    std::printf("replica_routing_test: OK\n");
+  }
+  return failures == 0 ? 0 : 1;
+}